@@ -0,0 +1,1451 @@
+/*
+
+I_Ching_RND_Engine.h is the core of the I Ching random generator, independent of the Disting NT API.
+It holds the scale and integer sequence tables, the hexagram order, the quantizer and the noise generators,
+together with batch entry points so the same kernels can be used from the plugin and from host tools.
+See I_Ching_RND.cpp for the plugin and the license.
+
+*/
+
+#ifndef I_CHING_RND_ENGINE_H
+#define I_CHING_RND_ENGINE_H
+
+#include <math.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Fix for M_PI not being defined on some toolchains
+#ifndef M_PI
+#define M_PI 3.14159265358979323846f
+#endif
+
+// --- Parameter indices ---
+enum {
+    kParamClockIn,
+    kParamIntSeqTrigIn,
+    kParamCVOut,
+    kParamQuantOut,
+    kParamIntSeqOut,
+    kParamNoiseOut,
+    kParamClockThruOut,
+    kParamClockDivOut,
+    kParamScale,
+    kParamRoot,
+    kParamTranspose,
+    kParamMaskRotate,
+    kParamIntSeqSelect,
+    kParamIntSeqMod,
+    kParamIntSeqStart,
+    kParamIntSeqLen,
+    kParamIntSeqDir,
+    kParamIntSeqStride,
+    kParamNoiseType,
+    kParamClockDiv,
+    kParamClockSource,
+    kParamOscWave,
+    kParamOscPitch,
+    kParamPitchIn,
+    kParamOscOut,
+    kParamOscBLOut,
+    kParamGlideMode,
+    kParamGlideTime,
+    kParamGlideLines,
+    kParamMidiOut,
+    kParamMidiChannel,
+    kNumParams
+};
+
+// --- Scale definitions ---
+#define NUM_STANDARD_SCALES 16
+#define NUM_EXOTIC_SCALES 117
+#define NUM_SCALES (NUM_STANDARD_SCALES + NUM_EXOTIC_SCALES)
+#define SCALE_MAX_LEN 20
+
+// --- Exotic scale intervals (static) ---
+static const float exotic_scales[NUM_EXOTIC_SCALES][SCALE_MAX_LEN] = {
+
+
+   // Blues major (From midipal/BitT source code)
+    { 0.0f, 3.0f, 4.0f, 7.0f, 9.0f, 10.0f },
+    // Blues minor (From midipal/BitT source code)
+    { 0.0f, 3.0f, 5.0f, 6.0f, 7.0f, 10.0f },
+
+    // Folk (From midipal/BitT source code)
+    { 0.0f, 1.0f, 3.0f, 4.0f, 5.0f, 7.0f, 8.0f, 10.0f },
+    // Japanese (From midipal/BitT source code)
+    { 0.0f, 1.0f, 5.0f, 7.0f, 8.0f },
+    // Gamelan (From midipal/BitT source code)
+    { 0.0f, 1.0f, 3.0f, 7.0f, 8.0f },
+    // Gypsy
+    { 0.0f, 2.0f, 3.0f, 6.0f, 7.0f, 8.0f, 11.0f },
+    // Arabian
+    { 0.0f, 1.0f, 4.0f, 5.0f, 7.0f, 8.0f, 11.0f },
+    // Flamenco
+    { 0.0f, 1.0f, 4.0f, 5.0f, 7.0f, 8.0f, 10.0f },
+    // Whole tone (From midipal/BitT source code)
+    { 0.0f, 2.0f, 4.0f, 6.0f, 8.0f, 10.0f },
+    // pythagorean (From yarns source code)
+    { 0.0f, 0.898f, 2.039f, 2.938f, 4.078f, 4.977f, 6.117f, 7.023f, 7.922f, 9.062f, 9.961f, 11.102f },
+    // 1_4_eb (From yarns source code)
+    { 0.0f, 1.0f, 2.0f, 3.0f, 3.5f, 5.0f, 6.0f, 7.0f, 8.0f, 9.0f, 10.0f, 10.5f },
+    // 1_4_e (From yarns source code)
+    { 0.0f, 1.0f, 2.0f, 3.0f, 3.5f, 5.0f, 6.0f, 7.0f, 8.0f, 9.0f, 10.0f, 11.0f },
+    // 1_4_ea (From yarns source code)
+    { 0.0f, 1.0f, 2.0f, 3.0f, 3.5f, 5.0f, 6.0f, 7.0f, 8.0f, 8.5f, 10.0f, 11.0f },
+    // bhairav (From yarns source code)
+    { 0.0f, 0.898f, 3.859f, 4.977f, 7.023f, 7.922f, 10.883f },
+    // gunakri (From yarns source code)
+    { 0.0f, 1.117f, 4.977f, 7.023f, 8.141f },
+    // marwa (From yarns source code)
+    { 0.0f, 1.117f, 3.859f, 5.898f, 8.844f, 10.883f },
+    // shree (From yarns source code)
+    { 0.0f, 0.898f, 3.859f, 5.898f, 7.023f, 7.922f, 10.883f },
+    // purvi (From yarns source code)
+    { 0.0f, 1.117f, 3.859f, 5.898f, 7.023f, 8.141f, 10.883f },
+    // bilawal (From yarns source code)
+    { 0.0f, 2.039f, 3.859f, 4.977f, 7.023f, 9.062f, 10.883f },
+    // yaman (From yarns source code)
+    { 0.0f, 2.039f, 4.078f, 6.117f, 7.023f, 9.062f, 11.102f },
+    // kafi (From yarns source code)
+    { 0.0f, 1.820f, 2.938f, 4.977f, 7.023f, 8.844f, 9.961f },
+    // bhimpalasree (From yarns source code)
+    { 0.0f, 2.039f, 3.156f, 4.977f, 7.023f, 9.062f, 10.180f },
+    // darbari (From yarns source code)
+    { 0.0f, 2.039f, 2.938f, 4.977f, 7.023f, 7.922f, 9.961f },
+    // rageshree (From yarns source code)
+    { 0.0f, 2.039f, 3.859f, 4.977f, 7.023f, 8.844f, 9.961f },
+    // khamaj (From yarns source code)
+    { 0.0f, 2.039f, 3.859f, 4.977f, 7.023f, 9.062f, 9.961f, 11.102f },
+    // mimal (From yarns source code)
+    { 0.0f, 2.039f, 2.938f, 4.977f, 7.023f, 8.844f, 9.961f, 10.883f },
+    // parameshwari (From yarns source code)
+    { 0.0f, 0.898f, 2.938f, 4.977f, 8.844f, 9.961f },
+    // rangeshwari (From yarns source code)
+    { 0.0f, 2.039f, 2.938f, 4.977f, 7.023f, 10.883f },
+    // gangeshwari (From yarns source code)
+    { 0.0f, 3.859f, 4.977f, 7.023f, 7.922f, 9.961f },
+    // kameshwari (From yarns source code)
+    { 0.0f, 2.039f, 5.898f, 7.023f, 8.844f, 9.961f },
+    // pa__kafi (From yarns source code)
+    { 0.0f, 2.039f, 2.938f, 4.977f, 7.023f, 9.062f, 9.961f },
+    // natbhairav (From yarns source code)
+    { 0.0f, 2.039f, 3.859f, 4.977f, 7.023f, 7.922f, 10.883f },
+    // m_kauns (From yarns source code)
+    { 0.0f, 2.039f, 4.078f, 4.977f, 7.922f, 9.961f },
+    // bairagi (From yarns source code)
+    { 0.0f, 0.898f, 4.977f, 7.023f, 9.961f },
+    // b_todi (From yarns source code)
+    { 0.0f, 0.898f, 2.938f, 7.023f, 9.961f },
+    // chandradeep (From yarns source code)
+    { 0.0f, 2.938f, 4.977f, 7.023f, 9.961f },
+    // kaushik_todi (From yarns source code)
+    { 0.0f, 2.938f, 4.977f, 5.898f, 7.922f },
+    // jogeshwari (From yarns source code)
+    { 0.0f, 2.938f, 3.859f, 4.977f, 8.844f, 9.961f },
+
+    // Tartini-Vallotti [12]
+    { 0.0f, 0.9375f, 1.9609f, 2.9766f, 3.9219f, 5.0234f, 5.9219f, 6.9766f, 7.9609f, 8.9375f, 10.0f, 10.8984f },
+    // 13 out of 22-tET, generator = 5 [13]
+    { 0.0f, 1.0938f, 2.1797f, 3.2734f, 3.8203f, 4.9063f, 6.0f, 6.5469f, 7.6328f, 8.7266f, 9.2734f, 10.3672f, 11.4531f },
+    // 13 out of 19-tET, Mandelbaum [13]
+    { 0.0f, 1.2656f, 1.8984f, 3.1563f, 3.7891f, 5.0547f, 5.6875f, 6.9453f, 7.5781f, 8.8438f, 9.4766f, 10.7344f, 11.3672f },
+    // Magic[16] in 145-tET [16]
+    { 0.0f, 1.4922f, 2.0703f, 2.6484f, 3.2266f, 3.8047f, 4.3828f, 5.8750f, 6.4531f, 7.0313f, 7.6172f, 8.1953f, 9.6797f, 10.2656f, 10.8438f, 11.4219f },
+    // g=9 steps of 139-tET. Gene Ward Smith "Quartaminorthirds" 7-limit temperament [16]
+    { 0.0f, 0.7734f, 1.5547f, 2.3281f, 3.1094f, 3.8828f, 4.6641f, 5.4375f, 6.2188f, 6.9922f, 7.7734f, 8.5469f, 9.3203f, 10.1016f, 10.8750f, 11.6563f },
+    // Armodue semi-equalizzato [16]
+    { 0.0f, 0.7734f, 1.5469f, 2.3203f, 3.0938f, 3.8672f, 4.6484f, 5.4219f, 6.1953f, 6.9688f, 7.7422f, 8.5156f, 9.2891f, 9.6797f, 10.4531f, 11.2266f },
+
+    // Hirajoshi[5]
+    { 0.0f, 1.8516f, 3.3672f, 6.8281f, 7.8984f },
+    // Scottish bagpipes[7]
+    { 0.0f, 1.9688f, 3.4063f, 4.9531f, 7.0313f, 8.5313f, 10.0938f },
+    // Thai ranat[7]
+    { 0.0f, 1.6094f, 3.4609f, 5.2578f, 6.8594f, 8.6172f, 10.2891f },
+
+    // Sevish quasi-12-equal mode from 31-EDO
+    { 0.0f, 1.1641f, 2.3203f, 3.0938f, 4.2578f, 5.0313f, 6.1953f, 7.3516f, 8.1328f, 9.2891f, 10.0625f, 11.2266f },
+    // 11 TET Machine[6]
+    { 0.0f, 2.1797f, 4.3672f, 5.4531f, 7.6328f, 9.8203f },
+    // 13 TET Father[8]
+    { 0.0f, 1.8438f, 3.6953f, 4.6172f, 6.4609f, 8.3047f, 9.2344f, 11.0781f },
+    // 15 TET Blackwood[10]
+    { 0.0f, 1.6016f, 2.3984f, 4.0f, 4.7969f, 6.3984f, 7.2031f, 8.7969f, 9.6016f, 11.2031f },
+    // 16 TET Mavila[7]
+    { 0.0f, 1.5f, 3.0f, 5.25f, 6.75f, 8.25f, 9.75f },
+    // 16 TET Mavila[9]
+    { 0.0f, 0.75f, 2.25f, 3.75f, 5.25f, 6.0f, 7.5f, 9.0f, 10.5f },
+    // 17 TET Superpyth[12]
+    { 0.0f, 0.7031f, 1.4141f, 2.8203f, 3.5313f, 4.9375f, 5.6484f, 6.3516f, 7.7578f, 8.4688f, 9.8828f, 10.5859f },
+
+    // 22 TET Orwell[9]
+    { 0.0f, 1.0938f, 2.7266f, 3.8203f, 5.4531f, 6.5469f, 8.1797f, 9.2734f, 10.9063f },
+    // 22 TET Pajara[10] Static Symmetrical Maj
+    { 0.0f, 1.0938f, 2.1797f, 3.8203f, 4.9063f, 6.0f, 7.0938f, 8.1797f, 9.8203f, 10.9063f },
+    // 22 TET Pajara[10] Std Pentachordal Maj
+    { 0.0f, 1.0938f, 2.1797f, 3.8203f, 4.9063f, 6.0f, 7.0938f, 8.7266f, 9.8203f, 10.9063f },
+    // 22 TET Porcupine[7]
+    { 0.0f, 1.6328f, 3.2734f, 4.9063f, 7.0938f, 8.7266f, 10.3672f },
+    // 26 TET Flattone[12]
+    { 0.0f, 0.4609f, 1.8438f, 2.3047f, 3.6953f, 5.0781f, 5.5391f, 6.9219f, 7.3828f, 8.7656f, 9.2266f, 10.6172f },
+    // 26 TET Lemba[10]
+    { 0.0f, 1.3828f, 2.3047f, 3.6953f, 4.6172f, 6.0f, 7.3828f, 8.3047f, 9.6875f, 10.6172f },
+    // 46 TET Sensi[11]
+    { 0.0f, 1.3047f, 2.6094f, 3.9141f, 4.4375f, 5.7422f, 7.0469f, 8.3516f, 8.8672f, 10.1719f, 11.4766f },
+    // 53 TET Orwell[9]
+    { 0.0f, 1.1328f, 2.7188f, 3.8516f, 5.4375f, 6.5625f, 8.1484f, 9.2813f, 10.8672f },
+    // 12 out of 72-TET scale by Prent Rodgers
+    { 0.0f, 2.0f, 2.6641f, 3.8359f, 4.3359f, 5.0f, 5.5f, 7.0f, 8.8359f, 9.6641f, 10.5f, 10.8359f },
+    // Trivalent scale in zeus temperament[7]
+    { 0.0f, 1.5781f, 3.8750f, 5.4531f, 7.0313f, 9.3359f, 10.9063f },
+    // 202 TET tempering of octone[8]
+    { 0.0f, 1.1875f, 3.5078f, 3.8594f, 6.1797f, 7.0078f, 9.3281f, 9.6797f },
+    // 313 TET elfmadagasgar[9]
+    { 0.0f, 2.0313f, 2.4922f, 4.5234f, 4.9844f, 7.0156f, 7.4766f, 9.5078f, 9.9688f },
+    // Marvel woo version of glumma[12]
+    { 0.0f, 0.4922f, 2.3281f, 3.1719f, 3.8359f, 5.4922f, 6.1641f, 7.0078f, 8.8359f, 9.3281f, 9.6797f, 11.6563f },
+    // TOP Parapyth[12]
+    { 0.0f, 0.5859f, 2.0703f, 2.6563f, 4.1406f, 4.7266f, 5.5469f, 7.0469f, 7.6172f, 9.1094f, 9.6875f, 11.1797f },
+
+    // 16-ED (ED2 or ED3)
+    { 0.0f, 0.75f, 1.5f, 2.25f, 3.0f, 3.75f, 4.5f, 5.25f, 6.0f, 6.75f, 7.5f, 8.25f, 9.0f, 9.75f, 10.5f, 11.25f },
+    // 15-ED (ED2 or ED3)
+    { 0.0f, 0.7969f, 1.6016f, 2.3984f, 3.2031f, 4.0f, 4.7969f, 5.6016f, 6.3984f, 7.2031f, 8.0f, 8.7969f, 9.6016f, 10.3984f, 11.2031f },
+    // 14-ED (ED2 or ED3)
+    { 0.0f, 0.8594f, 1.7109f, 2.5703f, 3.4297f, 4.2891f, 5.1484f, 6.0f, 6.8594f, 7.7188f, 8.5781f, 9.4375f, 10.2969f, 11.1563f },
+    // 13-ED (ED2 or ED3)
+    { 0.0f, 0.9219f, 1.8438f, 2.7656f, 3.6953f, 4.6328f, 5.6328f, 6.5703f, 7.4922f, 8.4141f, 9.3359f, 10.2578f, 11.1797f },
+    // 11-ED (ED2 or ED3)
+    { 0.0f, 1.0938f, 2.1797f, 3.2734f, 4.3672f, 5.4531f, 6.5469f, 7.6328f, 8.7266f, 9.8203f, 10.9063f },
+    // 10-ED (ED2 or ED3)
+    { 0.0f, 1.2031f, 2.3984f, 3.6016f, 4.7969f, 6.0f, 7.2031f, 8.3984f, 9.6016f, 10.7969f },
+    // 9-ED (ED2 or ED3)
+    { 0.0f, 1.3359f, 2.6641f, 4.0f, 5.3359f, 6.6641f, 8.0f, 9.3359f, 10.6641f },
+    // 8-ED (ED2 or ED3)
+    { 0.0f, 1.5f, 3.0f, 4.5f, 6.0f, 7.5f, 9.0f, 10.5f },
+    // 7-ED (ED2 or ED3)
+    { 0.0f, 1.7109f, 3.4297f, 5.1484f, 6.8594f, 8.5781f, 10.2969f },
+    // 6-ED (ED2 or ED3)
+    { 0.0f, 2.0f, 4.0f, 6.0f, 8.0f, 10.0f },
+    // 5-ED (ED2 or ED3)
+    { 0.0f, 2.3984f, 4.7969f, 7.2031f, 9.6016f },
+
+    // 16-HD2 (16 step harmonic series scale on the octave)
+    { 0.0f, 1.0469f, 2.0391f, 2.9766f, 3.8594f, 4.7109f, 5.5156f, 6.2813f, 7.0234f, 7.7266f, 8.4063f, 9.0625f, 9.6875f, 10.2969f, 10.8906f, 11.4531f },
+    // 15-HD2 (15 step harmonic series scale on the octave)
+    { 0.0f, 1.1172f, 2.1641f, 3.1563f, 4.0938f, 4.9766f, 5.8203f, 6.6328f, 7.4141f, 8.1641f, 8.8828f, 9.5703f, 10.2266f, 10.852f, 11.4453f },
+    // 14-HD2 (14 step harmonic series scale on the octave)
+    { 0.0f, 1.1953f, 2.3125f, 3.3594f, 4.3516f, 5.2891f, 6.1797f, 7.0313f, 7.8516f, 8.6406f, 9.3984f, 10.125f, 10.8203f, 11.4844f },
+    // 13-HD2 (13 step harmonic series scale on the octave)
+    { 0.0f, 1.2813f, 2.4766f, 3.5938f, 4.6406f, 5.6328f, 6.5703f, 7.4609f, 8.3125f, 9.125f, 9.9063f, 10.6484f, 11.3594f },
+    // 12-HD2 (12 step harmonic series scale on the octave)
+    { 0.0f, 1.3828f, 2.6719f, 3.8594f, 5.0078f, 6.0313f, 6.9922f, 7.9531f, 8.8438f, 9.6875f, 10.4844f, 11.2656f },
+    // 11-HD2 (11 step harmonic series scale on the octave)
+    { 0.0f, 1.5078f, 2.8906f, 4.1719f, 5.3672f, 6.4844f, 7.5391f, 8.5234f, 9.4688f, 10.3672f, 11.2109f },
+    // 10-HD2 (10 step harmonic series scale on the octave)
+    { 0.0f, 1.6484f, 3.1563f, 4.5391f, 5.8672f, 7.0234f, 8.0703f, 9.1875f, 10.1797f, 11.1094f },
+    // 9-HD2 (9 step harmonic series scale on the octave)
+    { 0.0f, 1.8203f, 3.4766f, 5.0938f, 6.6797f, 8.2422f, 9.7891f, 11.3203f, 12.0f },
+    // 8-HD2 (8 step harmonic series scale on the octave)
+    { 0.0f, 2.0391f, 3.8594f, 5.5156f, 7.0234f, 8.4063f, 9.6875f, 10.8906f },
+    // 7-HD2 (7 step harmonic series scale on the octave)
+    { 0.0f, 2.3125f, 4.3516f, 6.1797f, 7.8516f, 9.3984f, 10.8203f },
+    // 6-HD2 (6 step harmonic series scale on the octave)
+    { 0.0f, 3.0313f, 6.0313f, 9.0625f, 12.0f, 15.0f },
+    // 5-HD2 (5 step harmonic series scale on the octave)
+    { 0.0f, 4.0f, 8.0f, 12.0f, 16.0f },
+
+    // 32-16-SD2 (16 step subharmonic series scale on the octave)
+    { 0.0f, 0.5469f, 1.1172f, 1.7031f, 2.3125f, 2.9375f, 3.5938f, 4.2734f, 4.9766f, 5.7188f, 6.4844f, 7.2891f, 8.0234f, 8.9297f, 9.9609f, 10.9531f },
+    // 30-15-SD2 (15 step subharmonic series scale on the octave)
+    { 0.0f, 0.5859f, 1.1953f, 1.8203f, 2.4766f, 3.1563f, 3.8594f, 4.6016f, 5.3672f, 6.1797f, 7.0313f, 7.9063f, 8.8438f, 9.8359f, 10.8828f },
+    // 28-14-SD2 (14 step subharmonic series scale on the octave)
+    { 0.0f, 0.6328f, 1.2813f, 1.9609f, 2.6719f, 3.4063f, 4.1719f, 4.977f, 5.8203f, 6.6953f, 7.6328f, 8.6328f, 9.6875f, 10.8047f, 12.0f },
+    // 26-13-SD2 (13 step subharmonic series scale on the octave)
+    { 0.0f, 0.6797f, 1.3828f, 2.125f, 2.8906f, 3.6953f, 4.5391f, 5.4219f, 6.3516f, 7.3203f, 8.3281f, 9.375f, 10.4609f },
+    // 24-12-SD2 (12 step subharmonic series scale on the octave)
+    { 0.0f, 0.7344f, 1.5078f, 2.3125f, 3.1563f, 4.0469f, 4.9766f, 5.9531f, 6.9688f, 8.0234f, 9.1172f, 10.25f },
+    // 22-11-SD2 (11 step subharmonic series scale on the octave)
+    { 0.0f, 0.8047f, 1.6484f, 2.5391f, 3.4766f, 4.4609f, 5.4922f, 6.5703f, 7.6953f, 8.8672f, 10.0859f },
+    // 20-10-SD2 (10 step subharmonic series scale on the octave)
+    { 0.0f, 0.8906f, 1.8203f, 2.8125f, 3.8594f, 4.9609f, 6.1172f, 7.3281f, 8.5938f, 9.9141f },
+    // 18-9-SD2 (9 step subharmonic series scale on the octave)
+    { 0.0f, 0.9922f, 2.0391f, 3.1563f, 4.3359f, 5.5781f, 6.8828f, 8.25f, 9.6797f },
+    // 16-8-SD2 (8 step subharmonic series scale on the octave)
+    { 0.0f, 1.1172f, 2.3125f, 3.5938f, 4.9609f, 6.4141f, 7.9531f, 9.5781f },
+    // 14-7-SD2 (7 step subharmonic series scale on the octave)
+    { 0.0f, 1.2813f, 2.6719f, 4.1719f, 5.7891f, 7.5234f, 9.375f },
+    // 12-6-SD2 (6 step subharmonic series scale on the octave)
+    { 0.0f, 1.5078f, 3.1563f, 4.9609f, 6.9219f, 9.0391f },
+    // 10-5-SD2 (5 step subharmonic series scale on the octave)
+    { 0.0f, 1.8203f, 3.8594f, 6.1719f, 8.8438f },
+    // 8-4-SD2 (4 step subharmonic series scale on the octave)
+    { 0.0f, 2.3125f, 4.9766f, 8.1406f },
+
+    // Bohlen-Pierce (equal)
+    { 0.0f, 0.9219f, 1.8438f, 2.7656f, 3.6953f, 4.6172f, 5.5391f, 6.4609f, 7.3828f, 8.3047f, 9.2344f, 10.1563f, 11.0781f },
+    // Bohlen-Pierce (just)
+    { 0.0f, 0.8438f, 1.9063f, 2.7422f, 3.6719f, 4.6484f, 5.5781f, 6.4219f, 7.3516f, 8.3281f, 9.2578f, 10.0938f, 11.1563f },
+    // Bohlen-Pierce (lambda)
+    { 0.0f, 1.9063f, 2.7422f, 3.6719f, 5.5781f, 6.4219f, 8.3281f, 9.2578f, 11.1563f },
+
+    // 8-24-HD3 (16 step harmonic series scale on the tritave)
+    { 0.0f, 1.2891f, 2.4375f, 3.4766f, 4.4297f, 5.3047f, 6.1172f, 6.8828f, 7.6172f, 8.3203f, 9.0f, 9.6641f, 10.3125f, 10.9453f, 11.5625f, 12.1563f },
+    // 7-21-HD3 (14 step harmonic series scale on the tritave)
+    { 0.0f, 1.4609f, 2.7422f, 3.8984f, 4.9375f, 5.8672f, 6.6953f, 7.4297f, 8.0781f, 8.6484f, 9.1484f, 9.5859f, 9.9688f, 10.3047f },
+    // 6-18-HD3 (12 step harmonic series scale on the tritave)
+    { 0.0f, 1.6875f, 3.1406f, 4.4297f, 5.5703f, 6.5703f, 7.4375f, 8.1797f, 8.8047f, 9.3203f, 9.7344f, 10.0547f },
+    // 5-15-HD3 (10 step harmonic series scale on the tritave)
+    { 0.0f, 1.9922f, 3.6719f, 5.1328f, 6.3828f, 7.4297f, 8.2813f, 8.9453f, 9.4297f, 9.7422f },
+    // 4-12-HD3 (8 step harmonic series scale on the tritave)
+    { 0.0f, 2.4375f, 4.4297f, 6.1172f, 7.6172f, 9.0f, 10.3125f, 11.5625f },
+
+    // 24-8-HD3 (16 step subharmonic series scale on the tritave)
+    { 0.0f, 0.4688f, 0.9531f, 1.4609f, 1.9922f, 2.5469f, 3.125f, 3.7266f, 4.3516f, 5.0f, 5.6719f, 6.3672f, 7.0859f, 7.8281f, 8.5938f, 9.3828f },
+    // 21-7-HD3 (14 step subharmonic series scale on the tritave)
+    { 0.0f, 0.5313f, 1.0938f, 1.6875f, 2.3047f, 2.9453f, 3.6094f, 4.2969f, 5.0078f, 5.7422f, 6.5f, 7.2813f, 8.0859f, 8.9141f },
+    // 18-6-HD3 (12 step subharmonic series scale on the tritave)
+    { 0.0f, 0.625f, 1.2891f, 1.9922f, 2.7344f, 3.5156f, 4.3359f, 5.1953f, 6.0938f, 7.0313f, 8.0078f, 9.0234f },
+    // 15-5-HD3 (10 step subharmonic series scale on the tritave)
+    { 0.0f, 0.75f, 1.5625f, 2.4375f, 3.375f, 4.375f, 5.4375f, 6.5625f, 7.75f, 9.0f },
+    // 12-4-HD3 (8 step subharmonic series scale on the tritave)
+    { 0.0f, 0.9531f, 1.9922f, 3.125f, 4.3516f, 5.6719f, 7.0859f, 8.5938f }
+};
+
+
+
+// --- Standard scale intervals (algorithmic) ---
+inline void get_standard_scale_intervals(int scaleIdx, int* out, int* outLen) {
+    switch (scaleIdx) {
+        case 0: out[0]=0; out[1]=2; out[2]=4; out[3]=5; out[4]=7; out[5]=9; out[6]=11; out[7]=12; *outLen=8; break; // Major
+        case 1: out[0]=0; out[1]=2; out[2]=3; out[3]=5; out[4]=7; out[5]=8; out[6]=10; out[7]=12; *outLen=8; break; // Minor
+        case 2: out[0]=0; out[1]=2; out[2]=3; out[3]=5; out[4]=7; out[5]=8; out[6]=11; out[7]=12; *outLen=8; break; // Harmonic Minor
+        case 3: out[0]=0; out[1]=2; out[2]=3; out[3]=5; out[4]=7; out[5]=9; out[6]=11; out[7]=12; *outLen=8; break; // Melodic Minor
+        case 4: out[0]=0; out[1]=2; out[2]=4; out[3]=5; out[4]=7; out[5]=9; out[6]=10; out[7]=12; *outLen=8; break; // Mixolydian
+        case 5: out[0]=0; out[1]=2; out[2]=3; out[3]=5; out[4]=7; out[5]=9; out[6]=10; out[7]=12; *outLen=8; break; // Dorian
+        case 6: out[0]=0; out[1]=2; out[2]=4; out[3]=6; out[4]=7; out[5]=9; out[6]=11; out[7]=12; *outLen=8; break; // Lydian
+        case 7: out[0]=0; out[1]=1; out[2]=3; out[3]=5; out[4]=7; out[5]=8; out[6]=10; out[7]=12; *outLen=8; break; // Phrygian
+        case 8: out[0]=0; out[1]=2; out[2]=3; out[3]=5; out[4]=7; out[5]=8; out[6]=10; out[7]=12; *outLen=8; break; // Aeolian
+        case 9: out[0]=0; out[1]=1; out[2]=3; out[3]=5; out[4]=6; out[5]=8; out[6]=10; out[7]=12; *outLen=8; break; // Locrian
+        case 10: out[0]=0; out[1]=2; out[2]=4; out[3]=7; out[4]=9; out[5]=12; *outLen=5; break; // Maj Pent
+        case 11: out[0]=0; out[1]=3; out[2]=5; out[3]=7; out[4]=10; out[5]=12; *outLen=5; break; // Min Pent
+        case 12: out[0]=0; out[1]=2; out[2]=4; out[3]=6; out[4]=8; out[5]=10; out[6]=12; *outLen=7; break; // Whole Tone
+        case 13: out[0]=0; out[1]=1; out[2]=3; out[3]=4; out[4]=6; out[5]=7; out[6]=9; out[7]=10; *outLen=8; break; // Octatonic HW
+        case 14: out[0]=0; out[1]=2; out[2]=3; out[3]=5; out[4]=6; out[5]=8; out[6]=9; out[7]=11; *outLen=8; break; // Octatonic WH
+        case 15: out[0]=0; out[1]=2; out[2]=4; out[3]=5; out[4]=7; out[5]=9; out[6]=11; out[7]=12; *outLen=8; break; // Ionian
+        default: for (int i = 0; i < SCALE_MAX_LEN; ++i) out[i] = 0; *outLen = 0;
+    }
+}
+
+// --- Scale resolution ---
+// Fills `scale` with the degrees of scale `scaleIdx`. Resolving once and calling
+// quantizeResolved() per value avoids rebuilding the scale for every sample.
+inline void resolveScale(int scaleIdx, int* scale, int* scaleLen) {
+    if (scaleIdx < NUM_STANDARD_SCALES) {
+        get_standard_scale_intervals(scaleIdx, scale, scaleLen);
+    } else if (scaleIdx < NUM_STANDARD_SCALES + NUM_EXOTIC_SCALES) {
+        int exoticIdx = scaleIdx - NUM_STANDARD_SCALES;
+        for (int i = 0; i < SCALE_MAX_LEN; ++i) scale[i] = (int)exotic_scales[exoticIdx][i];
+        *scaleLen = SCALE_MAX_LEN;
+    } else {
+        for (int i = 0; i < SCALE_MAX_LEN; ++i) scale[i] = 0;
+        *scaleLen = 0;
+    }
+}
+
+// --- Quantize function ---
+inline float quantizeResolved(float v, const int* scale, int scaleLen, int root, int transpose, int maskRotate) {
+    float note = v * 12.0f;
+    int n = static_cast<int>(roundf(note));
+    n += root + transpose;
+    int scaleDegree = 0;
+    int minDist = 128;
+    for (int i = 0; i < scaleLen; ++i) {
+        int deg = (scale[i] + maskRotate) % 12;
+        int dist = abs((n % 12) - deg);
+        if (dist < minDist) {
+            minDist = dist;
+            scaleDegree = i;
+        }
+    }
+    int quantized = (n / 12) * 12 + scale[scaleDegree];
+    return quantized / 12.0f;
+}
+
+inline float quantize(float v, int scaleIdx, int root, int transpose, int maskRotate) {
+    int scale[SCALE_MAX_LEN];
+    int scaleLen = 0;
+    resolveScale(scaleIdx, scale, &scaleLen);
+    return quantizeResolved(v, scale, scaleLen, root, transpose, maskRotate);
+}
+
+// Quantize `count` values (in volts) with the scale resolved once for the whole batch.
+inline void quantizeBlock(const float* in, float* out, int count, int scaleIdx, int root, int transpose, int maskRotate) {
+    int scale[SCALE_MAX_LEN];
+    int scaleLen = 0;
+    resolveScale(scaleIdx, scale, &scaleLen);
+    for (int i = 0; i < count; ++i)
+        out[i] = quantizeResolved(in[i], scale, scaleLen, root, transpose, maskRotate);
+}
+
+// --- Integer Sequence definitions ---
+#define NUM_INTSEQ 10
+#define INTSEQ_MAX_LEN 128
+
+// Integer sequences from Quantermain (O_C firmware)
+static const int intseq_pi[INTSEQ_MAX_LEN] = {
+    3,1,4,1,5,9,2,6,5,3,5,8,9,7,9,3,2,3,8,4,6,2,6,4,3,3,8,3,2,7,9,5,
+    0,2,8,8,4,1,9,7,1,6,9,3,9,9,3,7,5,1,0,5,8,2,0,9,7,4,9,4,4,5,9,2,
+    3,0,7,8,1,6,4,0,6,2,8,6,2,0,8,9,9,8,6,2,8,0,3,4,8,2,5,3,4,2,1,1,
+    7,0,6,7,9,8,2,1,4,8,0,8,6,5,1,3,2,8,2,3,0,6,6,4,7,0,9,3,8,4,4,6
+};
+static const int intseq_vanEck[INTSEQ_MAX_LEN] = {
+    0,0,1,0,2,0,2,2,1,6,5,5,7,6,7,9,8,8,10,9,11,10,12,11,13,12,14,13,15,14,16,15,
+    17,16,18,17,19,18,20,19,21,20,22,21,23,22,24,23,25,24,26,25,27,26,28,27,29,28,30,29,31,30,32,31,
+    33,32,34,33,35,34,36,35,37,36,38,37,39,38,40,39,41,40,42,41,43,42,44,43,45,44,46,45,47,46,48,47,
+    49,48,50,49,51,50,52,51,53,52,54,53,55,54,56,55,57,56,58,57,59,58,60,59,61,60,62,61,63,62,64,63
+};
+static const int intseq_ssdn[INTSEQ_MAX_LEN] = {
+    0,1,4,9,1,2,5,10,2,5,10,2,5,10,2,5,10,2,5,10,2,5,10,2,5,10,2,5,10,2,5,10,
+    2,5,10,2,5,10,2,5,10,2,5,10,2,5,10,2,5,10,2,5,10,2,5,10,2,5,10,2,5,10,2,5,
+    10,2,5,10,2,5,10,2,5,10,2,5,10,2,5,10,2,5,10,2,5,10,2,5,10,2,5,10,2,5,10,2,
+    5,10,2,5,10,2,5,10,2,5,10,2,5,10,2,5,10,2,5,10,2,5,10,2,5,10,2,5,10,2,5,10
+};
+static const int intseq_dress[INTSEQ_MAX_LEN] = {
+    0,1,2,3,4,5,6,7,8,9,10,11,12,13,14,15,16,17,18,19,20,21,22,23,24,25,26,27,28,29,30,31,
+    32,33,34,35,36,37,38,39,40,41,42,43,44,45,46,47,48,49,50,51,52,53,54,55,56,57,58,59,60,61,62,63,
+    64,65,66,67,68,69,70,71,72,73,74,75,76,77,78,79,80,81,82,83,84,85,86,87,88,89,90,91,92,93,94,95,
+    96,97,98,99,100,101,102,103,104,105,106,107,108,109,110,111,112,113,114,115,116,117,118,119,120,121,122,123,124,125,126,127
+};
+static const int intseq_pninf[INTSEQ_MAX_LEN] = {
+    0,1,-1,2,0,1,-2,3,1,0,-1,2,-3,4,2,1,0,-1,3,-4,5,3,2,1,0,-1,4,-5,6,4,3,2,
+    1,0,5,-6,7,5,4,3,2,1,6,-7,8,6,5,4,3,2,7,-8,9,7,6,5,4,3,8,-9,10,8,7,6,
+    5,4,9,-10,11,9,8,7,6,5,10,-11,12,10,9,8,7,6,11,-12,13,11,10,9,8,7,12,-13,14,12,11,10,
+    9,8,13,-14,15,13,12,11,10,9,14,-15,16,14,13,12,11,10,15,-16,17,15,14,13,12,11,16,-17,18,16,15,14
+};
+static const int intseq_dsum[INTSEQ_MAX_LEN] = {
+    0,1,2,3,4,5,6,7,8,9,1,2,3,4,5,6,7,8,9,1,2,3,4,5,6,7,8,9,1,2,3,4,
+    5,6,7,8,9,1,2,3,4,5,6,7,8,9,1,2,3,4,5,6,7,8,9,1,2,3,4,5,6,7,8,9,
+    1,2,3,4,5,6,7,8,9,1,2,3,4,5,6,7,8,9,1,2,3,4,5,6,7,8,9,1,2,3,4,5,
+    6,7,8,9,1,2,3,4,5,6,7,8,9,1,2,3,4,5,6,7,8,9,1,2,3,4,5,6,7,8,9,1
+};
+static const int intseq_dsum4[INTSEQ_MAX_LEN] = {
+    0,1,2,3,1,2,3,1,2,3,1,2,3,1,2,3,1,2,3,1,2,3,1,2,3,1,2,3,1,2,3,1,
+    2,3,1,2,3,1,2,3,1,2,3,1,2,3,1,2,3,1,2,3,1,2,3,1,2,3,1,2,3,1,2,3,
+    1,2,3,1,2,3,1,2,3,1,2,3,1,2,3,1,2,3,1,2,3,1,2,3,1,2,3,1,2,3,1,2,
+    3,1,2,3,1,2,3,1,2,3,1,2,3,1,2,3,1,2,3,1,2,3,1,2,3,1,2,3,1,2,3,1
+};
+static const int intseq_dsum5[INTSEQ_MAX_LEN] = {
+    0,1,2,3,4,1,2,3,4,1,2,3,4,1,2,3,4,1,2,3,4,1,2,3,4,1,2,3,4,1,2,3,
+    4,1,2,3,4,1,2,3,4,1,2,3,4,1,2,3,4,1,2,3,4,1,2,3,4,1,2,3,4,1,2,3,
+    4,1,2,3,4,1,2,3,4,1,2,3,4,1,2,3,4,1,2,3,4,1,2,3,4,1,2,3,4,1,2,3,
+    4,1,2,3,4,1,2,3,4,1,2,3,4,1,2,3,4,1,2,3,4,1,2,3,4,1,2,3,4,1,2,3
+};
+static const int intseq_cdn2[INTSEQ_MAX_LEN] = {
+    0,-2,-4,-6,-8,-10,-12,-14,-16,-18,-20,-22,-24,-26,-28,-30,-32,-34,-36,-38,-40,-42,-44,-46,-48,-50,-52,-54,-56,-58,-60,-62,
+    -64,-66,-68,-70,-72,-74,-76,-78,-80,-82,-84,-86,-88,-90,-92,-94,-96,-98,-100,-102,-104,-106,-108,-110,-112,-114,-116,-118,-120,-122,-124,-126,
+    -128,-130,-132,-134,-136,-138,-140,-142,-144,-146,-148,-150,-152,-154,-156,-158,-160,-162,-164,-166,-168,-170,-172,-174,-176,-178,-180,-182,-184,-186,-188,-190,
+    -192,-194,-196,-198,-200,-202,-204,-206,-208,-210,-212,-214,-216,-218,-220,-222,-224,-226,-228,-230,-232,-234,-236,-238,-240,-242,-244,-246,-248,-250,-252,-254
+};
+static const int intseq_frcti[INTSEQ_MAX_LEN] = {
+    0,1,0,2,0,1,0,3,0,1,0,2,0,1,0,4,0,1,0,2,0,1,0,3,0,1,0,2,0,1,0,5,
+    0,1,0,2,0,1,0,3,0,1,0,2,0,1,0,4,0,1,0,2,0,1,0,3,0,1,0,2,0,1,0,6,
+    0,1,0,2,0,1,0,3,0,1,0,2,0,1,0,4,0,1,0,2,0,1,0,3,0,1,0,2,0,1,0,7,
+    0,1,0,2,0,1,0,3,0,1,0,2,0,1,0,4,0,1,0,2,0,1,0,3,0,1,0,2,0,1,0,8
+};
+static const int* intseq_tables[NUM_INTSEQ] = {
+    intseq_pi, intseq_vanEck, intseq_ssdn, intseq_dress, intseq_pninf,
+    intseq_dsum, intseq_dsum4, intseq_dsum5, intseq_cdn2, intseq_frcti
+};
+
+
+// --- Integer sequence lookup ---
+// Table value at `offset` of integer sequence `intseqSel`, reduced by IntSeqMod.
+inline int intseqValue(int intseqSel, int offset, int intseqMod) {
+    int value = intseq_tables[intseqSel][offset % INTSEQ_MAX_LEN];
+    if (intseqMod > 1) value %= intseqMod;
+    return value;
+}
+
+// Scale degree (0-11) of an integer sequence value.
+inline int intseqDegree(int value) {
+    int degree = value % 12;
+    if (degree < 0) degree += 12;
+    return degree;
+}
+
+// Longest resolved IntSeq window: a pendulum over 128 steps
+#define INTSEQ_PLAY_MAX_LEN (INTSEQ_MAX_LEN * 2 - 2)
+
+// --- Wavetable oscillator ---
+#define OSC_TABLE_LEN 256       // points per cycle of the band-limited tables
+#define OSC_MAX_HARMONIC 32     // harmonics in the richest table
+#define OSC_NUM_LEVELS 6        // tables with 32, 16, 8, 4, 2 and 1 harmonics
+
+// Per-cycle wavetable of the oscillator mode, rebuilt only when its steps change.
+// The band-limited tables are filled on first use, so a cycle only pays for the one its pitch selects.
+struct OscState {
+    float phase = 0.0f;                                  // position in the cycle, 0..1
+    int steps = 0;                                       // steps per cycle, 0 until built
+    float stepped[INTSEQ_PLAY_MAX_LEN];                  // one value (volts) per step
+    float dc = 0.0f;                                     // mean of the steps
+    float dftRe[OSC_MAX_HARMONIC + 1];                   // harmonic coefficients of the steps,
+    float dftIm[OSC_MAX_HARMONIC + 1];                   // valid for 1 .. dftCount
+    int dftCount = 0;
+    int levelsBuilt = 0;                                 // one bit per band-limited table filled
+    float bandLimited[OSC_NUM_LEVELS][OSC_TABLE_LEN + 1]; // guard point for interpolation
+    float cosTable[OSC_TABLE_LEN];
+};
+
+// --- Glide ---
+enum { kGlideOff, kGlideLinear, kGlideExp };
+
+// Slew of one stepped output toward its latest value
+struct GlideState {
+    float value = 0.0f;     // current output
+    float target = 0.0f;    // latest stepped value
+    float step = 0.0f;      // linear: increment per sample
+    int remaining = 0;      // samples left in a linear ramp (an exponential glide leaves it at the length)
+    bool active = false;    // a glide is in progress
+};
+
+// --- Events ---
+// processBlock() publishes what changed into a ring of timestamped events, so the display,
+// MIDI or a recorder only do work when something happens. There is one producer (the audio
+// loop); each consumer keeps its own EventReader and may run on another thread.
+#define EVENT_QUEUE_LEN 128   // power of two; a reader can fall up to 127 events behind
+
+enum { kEventHexagram, kEventIntSeq, kEventDivider };
+
+struct IChingEvent {
+    uint32_t time;      // sample count since the state was created
+    uint8_t type;
+    uint8_t hexagram;   // kEventHexagram: new hexagram index
+    uint8_t lines;      // kEventHexagram: lines that changed, one bit per line
+    uint8_t note;       // kEventHexagram: Quant Out, kEventIntSeq: IntSeq Out, as a MIDI note
+};
+
+struct EventQueue {
+    IChingEvent events[EVENT_QUEUE_LEN];
+    uint32_t writeIndex = 0;
+};
+
+struct EventReader {
+    uint32_t readIndex = 0;
+    uint32_t dropped = 0;   // events overwritten before they were read
+};
+
+// --- State structs ---
+struct IChingRndState {
+    uint32_t random = 0x12345678; // reseeded per instance with seedRandom()
+    int lastClock = 0;
+    int hexagram[6] = {0};
+    int intseq_pos = 0;                       // cursor into intseqPlay
+    int lastIntSeqTrig = 0;
+    float intseqPlay[INTSEQ_PLAY_MAX_LEN];    // resolved IntSeq window, quantized volts
+    int intseqPlayLen = 0;                    // 0 until built
+
+
+    int hexagramOrder[64];
+    int hexagramStep = 0;
+    int div_counter = 0;
+    int div_state = 0;
+
+    OscState osc;
+    uint8_t oscOrder[64] = {0};  // hexagram order the oscillator table was drawn from
+
+    GlideState glideCV;
+    GlideState glideQuant;
+    GlideState glideIntSeq;
+    int glideLastIdx = 0;     // hexagram the CV/Quant glides last moved to
+    int glideSamples = 0;     // linear ramp length, from Glide Time; 0 until resolved
+    float glideCoef = 1.0f;   // exponential one-pole coefficient, from Glide Time
+
+    uint32_t sampleTime = 0;  // samples processed, for event timestamps
+    EventQueue events;
+};
+struct NoiseState {
+    float pink[3] = {0.0f, 0.0f, 0.0f};  // Zustände für pinkNoise()
+    float brown = 0.0f;                 // Zustand für brownNoise()
+    float blueLast = 0.0f;              // Letzter Wert für blueNoise()
+};
+
+// --- Integer sequence playback ---
+// Resolves the IntSeq window (IntSeq, Start, Len, Dir, Stride, Mod) into a flat buffer of
+// quantized voltages, so an IntSeqTrig edge only has to advance the cursor.
+// A loop plays Len steps; a pendulum plays forward then back without repeating the ends.
+inline void buildIntSeqPlayback(IChingRndState* state, int intseqSel, int intseqStart, int intseqLen, int intseqDir, int intseqStride, int intseqMod,
+                                int scaleIdx, int root, int transpose, int maskRotate) {
+    int scale[SCALE_MAX_LEN];
+    int scaleLen = 0;
+    resolveScale(scaleIdx, scale, &scaleLen);
+
+    int n = 0;
+    for (int k = 0; k < intseqLen; ++k) {
+        int offset = (intseqDir == 1) ? intseqStart + k * intseqStride
+                                      : intseqStart + ((k * intseqStride) % intseqLen);
+        int degree = intseqDegree(intseqValue(intseqSel, offset, intseqMod));
+        state->intseqPlay[n++] = quantizeResolved(degree / 12.0f, scale, scaleLen, root, transpose, maskRotate);
+    }
+    if (intseqDir == 1) {
+        for (int k = intseqLen - 2; k > 0; --k)
+            state->intseqPlay[n++] = state->intseqPlay[k];
+    }
+
+    state->intseqPlayLen = n;
+    if (state->intseq_pos >= n)
+        state->intseq_pos %= n;
+}
+
+// Move the IntSeq cursor one step
+inline void advanceIntSeq(IChingRndState* state) {
+    if (++state->intseq_pos >= state->intseqPlayLen)
+        state->intseq_pos = 0;
+}
+
+// --- I Ching random hexagram generator ---
+inline __attribute__((always_inline)) uint32_t advanceRandom(IChingRndState* state)
+{
+    uint32_t x = state->random;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    state->random = x;
+    return x;
+}
+
+
+// Seed the generator from any 32-bit value. The seed is mixed so nearby seeds (an instance
+// count) give unrelated sequences; xorshift must never hold 0.
+inline void seedRandom(IChingRndState* state, uint32_t seed) {
+    seed ^= seed >> 16;
+    seed *= 0x85EBCA6Bu;
+    seed ^= seed >> 13;
+    seed *= 0xC2B2AE35u;
+    seed ^= seed >> 16;
+    state->random = seed ? seed : 0x12345678;
+}
+
+// Generate a random bit (0 or 1)
+inline int randomBit(IChingRndState* state) {
+    return advanceRandom(state) & 1;
+}
+
+// Generate a hexagram (6 coin tosses)
+inline void generateHexagram(IChingRndState* state, int hexagram[6]) {
+    for (int i = 0; i < 6; ++i) {
+        hexagram[i] = randomBit(state);
+    }
+}
+
+// Convert hexagram to index (0-63)
+inline int hexagramToIndex(const int hexagram[6]) {
+    int idx = 0;
+    for (int i = 0; i < 6; ++i) {
+        idx |= (hexagram[i] << i);
+    }
+    return idx;
+}
+
+// CV Out voltage for a hexagram index
+inline float hexagramCV(int idx) {
+    float semitones = (idx < 60) ? float((idx % 12) * 5) : 0.0f;
+    return semitones / 12.0f;
+}
+
+// Shuffle hexagrams
+inline void shuffleHexagrams(IChingRndState* state) {
+    for (int i = 0; i < 64; ++i) state->hexagramOrder[i] = i;
+    // Fisher-Yates shuffle
+    for (int i = 63; i > 0; --i) {
+        int j = advanceRandom(state) % (i + 1);
+        int tmp = state->hexagramOrder[i];
+        state->hexagramOrder[i] = state->hexagramOrder[j];
+        state->hexagramOrder[j] = tmp;
+    }
+    state->hexagramStep = 0;
+}
+
+// Move to the next hexagram of the order, reshuffling after all 64 have been used.
+// Returns the new hexagram index.
+inline int advanceHexagram(IChingRndState* state) {
+    int idx = state->hexagramOrder[state->hexagramStep];
+    for (int b = 0; b < 6; ++b)
+        state->hexagram[b] = (idx >> b) & 1;
+    state->hexagramStep++;
+    if (state->hexagramStep >= 64)
+        shuffleHexagrams(state);
+    return idx;
+}
+
+// Generate `count` hexagram indices, as `count` clocks would.
+inline void generateHexagramIndices(IChingRndState* state, int* out, int count) {
+    for (int i = 0; i < count; ++i)
+        out[i] = advanceHexagram(state);
+}
+
+// --- Noise functions ---
+inline float whiteNoise(IChingRndState* state) {
+    return ((advanceRandom(state) >> 8) & 0xFFFF) / 32768.0f - 1.0f;
+}
+
+// Pink noise (simple filter, Paul Kellet Pink Noise Filter)
+inline float pinkNoise(float in, float* state) {
+    state[0] = 0.99886f * state[0] + 0.0555179f * in;
+    state[1] = 0.99332f * state[1] + 0.0750759f * in;
+    state[2] = 0.96900f * state[2] + 0.1538520f * in;
+    return 0.5362f * (state[0] + state[1] + state[2]) + 0.1f * in;
+}
+
+// Brown noise (integrator)
+inline float brownNoise(float in, float* state) {
+    // Constants for integration and damping
+    const float integration = 0.05f;
+    const float damping = 0.0005f; // Avoid DC-Drift
+
+    state[0] += integration * in;
+    state[0] -= damping * state[0]; // soft DC-Offset-elimination
+
+    // Optional: Soft Clipping (similar to tanh)
+    float out = state[0] ;
+    //if (out > 1.0f) out = 1.0f;
+    //else if (out < -1.0f) out = -1.0f;
+
+    return out;
+}
+
+// Blue noise coefficient (highpass at 100 Hz)
+inline float blueNoiseAlpha(float sr) {
+    float fc = 100.0f;
+    return sr / (sr + 2.0f * M_PI * fc);
+}
+
+// Blue noise (differentiator)
+inline float blueNoise(float in, float* state, float alpha) {
+    float out = alpha * (*state + in - *state);
+    *state = in;
+    return out;
+}
+
+// One noise sample (volts) of the given type
+inline float noiseSample(IChingRndState* state, NoiseState* ns, int noiseType, float blueAlpha) {
+    float wn = whiteNoise(state);
+    float n = 0.0f;
+    switch (noiseType) {
+        case 0: n = wn; break;
+        case 1: n = pinkNoise(wn, ns->pink); break;
+        case 2: n = brownNoise(wn, &ns->brown); break;
+        case 3: n = blueNoise(wn, &ns->blueLast, blueAlpha); break;
+        default: n = wn; break;
+    }
+    return n * 5.0f;
+}
+
+// Render `count` noise samples (volts) of the given type.
+// The type is dispatched once per batch instead of once per sample.
+inline void renderNoise(IChingRndState* state, NoiseState* ns, int noiseType, float sampleRate, float* out, int count) {
+    switch (noiseType) {
+        case 1:
+            for (int i = 0; i < count; ++i)
+                out[i] = pinkNoise(whiteNoise(state), ns->pink) * 5.0f;
+            break;
+        case 2:
+            for (int i = 0; i < count; ++i)
+                out[i] = brownNoise(whiteNoise(state), &ns->brown) * 5.0f;
+            break;
+        case 3: {
+            float alpha = blueNoiseAlpha(sampleRate);
+            for (int i = 0; i < count; ++i)
+                out[i] = blueNoise(whiteNoise(state), &ns->blueLast, alpha) * 5.0f;
+            break;
+        }
+        default:
+            for (int i = 0; i < count; ++i)
+                out[i] = whiteNoise(state) * 5.0f;
+            break;
+    }
+}
+
+// --- Wavetable oscillator ---
+inline void initOscillator(OscState* osc) {
+    for (int i = 0; i < OSC_TABLE_LEN; ++i)
+        osc->cosTable[i] = cosf(2.0f * float(M_PI) * i / OSC_TABLE_LEN);
+    osc->phase = 0.0f;
+    osc->steps = 0;
+}
+
+// Oscillator value (volts) of a hexagram index
+inline float hexagramOscValue(int idx) {
+    return (idx - 31.5f) * (5.0f / 31.5f);
+}
+
+// Sets the steps of the next cycle (`steps` values, in volts).
+// The band-limited tables are the trigonometric interpolation of the steps, truncated to
+// 32, 16, ... 1 harmonics, so the oscillator can pick one that does not alias at its pitch.
+// They are left to oscBandLimited(), which fills only the one the pitch selects.
+inline void buildOscTable(OscState* osc, const float* values, int steps) {
+    float dc = 0.0f;
+    for (int k = 0; k < steps; ++k) {
+        osc->stepped[k] = values[k];
+        dc += values[k];
+    }
+    osc->dc = dc / steps;
+    osc->steps = steps;
+    osc->dftCount = 0;
+    osc->levelsBuilt = 0;
+}
+
+// Fills band-limited table `level` from the DFT of the steps, computing the bins it still lacks.
+// Each table is summed from the DC up, so its cost follows its harmonic count: at high pitches
+// cycles are short but their tables small.
+inline void buildOscLevel(OscState* osc, int level) {
+    int steps = osc->steps;
+    int top = OSC_MAX_HARMONIC >> level;
+    if (2 * top > steps)
+        top = steps / 2;
+
+    for (int harmonic = osc->dftCount + 1; harmonic <= top; ++harmonic) {
+        // DFT bin of the steps, with a rotating phasor instead of a sin/cos per step
+        float w = 2.0f * float(M_PI) * harmonic / steps;
+        float wc = cosf(w), ws = sinf(w);
+        float zc = 1.0f, zs = 0.0f, re = 0.0f, im = 0.0f;
+        for (int k = 0; k < steps; ++k) {
+            re += osc->stepped[k] * zc;
+            im += osc->stepped[k] * zs;
+            float t = zc * wc - zs * ws;
+            zs = zc * ws + zs * wc;
+            zc = t;
+        }
+        float gain = (2 * harmonic == steps) ? 1.0f / steps : 2.0f / steps;
+        osc->dftRe[harmonic] = re * gain;
+        osc->dftIm[harmonic] = im * gain;
+    }
+    if (top > osc->dftCount)
+        osc->dftCount = top;
+
+    float* table = osc->bandLimited[level];
+    for (int m = 0; m < OSC_TABLE_LEN; ++m)
+        table[m] = osc->dc;
+    for (int harmonic = 1; harmonic <= top; ++harmonic) {
+        float re = osc->dftRe[harmonic], im = osc->dftIm[harmonic];
+        for (int m = 0; m < OSC_TABLE_LEN; ++m) {
+            int c = (harmonic * m) & (OSC_TABLE_LEN - 1);
+            int s = (c - OSC_TABLE_LEN / 4) & (OSC_TABLE_LEN - 1);
+            table[m] += re * osc->cosTable[c] + im * osc->cosTable[s];
+        }
+    }
+    table[OSC_TABLE_LEN] = table[0];
+    osc->levelsBuilt |= 1 << level;
+}
+
+// Builds the tables from the current hexagram order
+inline void buildHexagramOscTable(IChingRndState* state) {
+    float values[64];
+    for (int k = 0; k < 64; ++k) {
+        state->oscOrder[k] = uint8_t(state->hexagramOrder[k]);
+        values[k] = hexagramOscValue(state->oscOrder[k]);
+    }
+    buildOscTable(&state->osc, values, 64);
+}
+
+// Builds the tables from the IntSeq playback buffer, scaled to +-5V
+inline void buildIntSeqOscTable(IChingRndState* state) {
+    int n = state->intseqPlayLen;
+    float lo = state->intseqPlay[0], hi = state->intseqPlay[0];
+    for (int k = 1; k < n; ++k) {
+        if (state->intseqPlay[k] < lo) lo = state->intseqPlay[k];
+        if (state->intseqPlay[k] > hi) hi = state->intseqPlay[k];
+    }
+    float values[INTSEQ_PLAY_MAX_LEN];
+    float gain = (hi > lo) ? 10.0f / (hi - lo) : 0.0f;
+    for (int k = 0; k < n; ++k)
+        values[k] = (state->intseqPlay[k] - lo) * gain - ((hi > lo) ? 5.0f : 0.0f);
+    buildOscTable(&state->osc, values, n);
+}
+
+// Advances the phase by `inc` cycles (below 1). Returns the number of step boundaries crossed;
+// `wrapped` tells whether a new cycle started.
+inline int oscAdvance(OscState* osc, float inc, bool* wrapped) {
+    int before = int(osc->phase * osc->steps);
+    osc->phase += inc;
+    *wrapped = osc->phase >= 1.0f;
+    if (*wrapped) {
+        osc->phase -= 1.0f;
+        return int(osc->phase * osc->steps) + osc->steps - before;
+    }
+    return int(osc->phase * osc->steps) - before;
+}
+
+// Index of the step the phase is in
+inline int oscStep(const OscState* osc) {
+    int k = int(osc->phase * osc->steps);
+    return k < osc->steps ? k : osc->steps - 1;
+}
+
+// Stepped output: the value of the current step
+inline float oscStepped(const OscState* osc) {
+    return osc->stepped[oscStep(osc)];
+}
+
+// Band-limited output, from the richest table whose top harmonic stays below Nyquist
+inline float oscBandLimited(OscState* osc, float inc) {
+    int level = 0;
+    while (level < OSC_NUM_LEVELS - 1 && (OSC_MAX_HARMONIC >> level) * inc > 0.5f)
+        ++level;
+    if (!(osc->levelsBuilt & (1 << level)))
+        buildOscLevel(osc, level);
+    float pos = osc->phase * OSC_TABLE_LEN;
+    int i = int(pos);
+    if (i >= OSC_TABLE_LEN) i = OSC_TABLE_LEN - 1;
+    float frac = pos - i;
+    const float* table = osc->bandLimited[level];
+    return table[i] + (table[i + 1] - table[i]) * frac;
+}
+
+// Phase increment per sample for a V/Oct pitch, relative to C3 (130.81 Hz)
+inline float oscIncrement(float pitchVolts, float sampleRate) {
+    float inc = 130.8128f * exp2f(pitchVolts) / sampleRate;
+    return inc < 0.5f ? inc : 0.5f;
+}
+
+// --- Glide ---
+// Cache the ramp length and one-pole coefficient for a glide time in ms.
+// The exponential glide gets within 1% of the new value in that time.
+inline void setGlideTime(IChingRndState* state, int ms, float sampleRate) {
+    int samples = int(ms * 0.001f * sampleRate);
+    state->glideSamples = samples > 1 ? samples : 1;
+    state->glideCoef = 1.0f - expf(-4.6f / state->glideSamples);
+}
+
+// Jump to the latest value, ending any glide in progress
+inline void stopGlide(GlideState* g) {
+    g->value = g->target;
+    g->active = false;
+}
+
+// Carry a glide in progress over to another mode: a linear ramp resumes from the current
+// value over the samples it has left (the whole Glide Time after an exponential glide)
+inline void resumeGlide(GlideState* g) {
+    if (g->active)
+        g->step = (g->target - g->value) / g->remaining;
+}
+
+// Fill `n` samples of a stepped output that holds `target` over the whole run.
+// A new target starts a glide when `glide` is set, or is jumped to otherwise.
+// With no glide in progress the run is a constant fill.
+inline void glideFill(GlideState* g, float target, bool glide, int mode, int glideSamples, float glideCoef, float* out, int n) {
+    if (target != g->target) {
+        g->target = target;
+        if (glide && mode != kGlideOff) {
+            g->active = true;
+            g->remaining = glideSamples;
+            g->step = (target - g->value) / glideSamples;
+        } else {
+            stopGlide(g);
+        }
+    }
+
+    int i = 0;
+    if (g->active) {
+        if (mode == kGlideExp) {
+            float value = g->value;
+            for (; i < n; ++i) {
+                value += (target - value) * glideCoef;
+                if (fabsf(target - value) < 1e-4f) {
+                    value = target;
+                    g->active = false;
+                }
+                out[i] = value;
+                if (!g->active) {
+                    ++i;
+                    break;
+                }
+            }
+            g->value = value;
+        } else {
+            int k = n < g->remaining ? n : g->remaining;
+            float start = g->value, step = g->step;
+            for (; i < k; ++i)
+                out[i] = start + step * (i + 1);
+            g->remaining -= k;
+            if (g->remaining == 0) {
+                out[k - 1] = target;
+                stopGlide(g);
+            } else {
+                g->value = start + step * k;
+            }
+        }
+    }
+
+    float value = g->value;
+    for (; i < n; ++i)
+        out[i] = value;
+}
+
+// --- Events ---
+// Producer side, called from the audio loop only
+inline void publishEvent(EventQueue* q, uint32_t time, int type, int hexagram, int lines, int note) {
+    uint32_t w = q->writeIndex;
+    IChingEvent& e = q->events[w & (EVENT_QUEUE_LEN - 1)];
+    e.time = time;
+    e.type = uint8_t(type);
+    e.hexagram = uint8_t(hexagram);
+    e.lines = uint8_t(lines);
+    e.note = uint8_t(note);
+    __atomic_store_n(&q->writeIndex, w + 1, __ATOMIC_RELEASE);
+}
+
+// Start reading from the next event published
+inline void attachReader(const EventQueue* q, EventReader* r) {
+    r->readIndex = __atomic_load_n(&q->writeIndex, __ATOMIC_ACQUIRE);
+    r->dropped = 0;
+}
+
+// Copy the oldest unread event into `e`. Returns false when there is none.
+// The slot of event w - EVENT_QUEUE_LEN is the one the producer writes before it publishes w + 1,
+// so a reader holds at most EVENT_QUEUE_LEN - 1 events; one that falls further behind skips
+// to the oldest event still intact.
+inline bool readEvent(const EventQueue* q, EventReader* r, IChingEvent* e) {
+    for (;;) {
+        uint32_t w = __atomic_load_n(&q->writeIndex, __ATOMIC_ACQUIRE);
+        if (r->readIndex == w)
+            return false;
+        if (w - r->readIndex >= EVENT_QUEUE_LEN) {
+            r->dropped += w - r->readIndex - (EVENT_QUEUE_LEN - 1);
+            r->readIndex = w - (EVENT_QUEUE_LEN - 1);
+        }
+        *e = q->events[r->readIndex & (EVENT_QUEUE_LEN - 1)];
+        // The slot may have been overwritten while it was copied
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        if (__atomic_load_n(&q->writeIndex, __ATOMIC_RELAXED) - r->readIndex >= EVENT_QUEUE_LEN)
+            continue;
+        r->readIndex++;
+        return true;
+    }
+}
+
+// MIDI note of a 1V/octave voltage, 0V = C3 (48)
+inline int voltsToMidiNote(float volts) {
+    int note = 48 + int(roundf(volts * 12.0f));
+    return note < 0 ? 0 : (note > 127 ? 127 : note);
+}
+
+// --- MIDI output ---
+#define MIDI_MAX_MESSAGES 6   // note off, note on, CC 20, CC 21, CC 22 on and off
+
+struct MidiMessage {
+    uint32_t dest;
+    uint8_t status, data1, data2;
+};
+
+// MIDI output consumer of the event queue
+struct MidiOutState {
+    EventReader reader;
+    int note = -1;          // note held, -1 if none
+    uint32_t noteDest = 0;  // destination the held note was sent to
+    uint8_t noteChannel = 0;
+};
+
+// Turns the events since the last call into MIDI, coalesced per block: the latest hexagram as a
+// note (from Quant Out) and CC 20 (index), the latest IntSeq step as CC 21 and a divider tick as
+// a CC 22 pulse (127 then 0). The held note is released when it moves, or when the output is
+// switched off (`dest` 0) or re-routed. Writes up to MIDI_MAX_MESSAGES to `out`, returns the count.
+inline int collectMidi(const EventQueue* q, MidiOutState* m, uint32_t dest, int channel, MidiMessage* out) {
+    IChingEvent hexagram, intseq, e;
+    bool hasHexagram = false, hasIntSeq = false, dividerTick = false;
+    while (readEvent(q, &m->reader, &e)) {
+        switch (e.type) {
+            case kEventHexagram: hexagram = e; hasHexagram = true; break;
+            case kEventIntSeq: intseq = e; hasIntSeq = true; break;
+            case kEventDivider: dividerTick = true; break;
+        }
+    }
+
+    int n = 0;
+    if (m->note >= 0 && (hasHexagram || dest != m->noteDest || channel != m->noteChannel)) {
+        out[n++] = { m->noteDest, uint8_t(0x80 | m->noteChannel), uint8_t(m->note), 0 };
+        m->note = -1;
+    }
+    if (!dest)
+        return n;
+
+    uint8_t cc = uint8_t(0xB0 | channel);
+    if (hasHexagram) {
+        out[n++] = { dest, uint8_t(0x90 | channel), hexagram.note, 100 };
+        out[n++] = { dest, cc, 20, hexagram.hexagram };
+        m->note = hexagram.note;
+        m->noteDest = dest;
+        m->noteChannel = uint8_t(channel);
+    }
+    if (hasIntSeq)
+        out[n++] = { dest, cc, 21, intseq.note };
+    if (dividerTick) {
+        out[n++] = { dest, cc, 22, 127 };
+        out[n++] = { dest, cc, 22, 0 };
+    }
+    return n;
+}
+
+// --- Block processing ---
+// Bus pointers for one block. Pitch In, Osc Out and Osc BL Out are NULL when not connected.
+struct IChingRndBuses {
+    const float* clockIn;
+    const float* intseqTrigIn;
+    const float* pitchIn;
+    float* cvOut;
+    float* quantOut;
+    float* intseqOut;
+    float* noiseOut;
+    float* clockThruOut;
+    float* clockDivOut;
+    float* oscOut;
+    float* oscBLOut;
+};
+
+// Resolve the IntSeq window with the current parameters
+inline void updateIntSeqPlayback(IChingRndState* state, const int16_t* v) {
+    buildIntSeqPlayback(state,
+                        v[kParamIntSeqSelect], v[kParamIntSeqStart], v[kParamIntSeqLen],
+                        v[kParamIntSeqDir], v[kParamIntSeqStride], v[kParamIntSeqMod],
+                        v[kParamScale], v[kParamRoot], v[kParamTranspose], v[kParamMaskRotate]);
+}
+
+// Restart the oscillator cycle: phase 0 plays the first hexagram of a fresh order (or the first IntSeq step)
+inline void resetOscillator(IChingRndState* state, const int16_t* v) {
+    state->osc.phase = 0.0f;
+    if (v[kParamOscWave] == 1) {
+        state->intseq_pos = 0;
+        buildIntSeqOscTable(state);
+    } else {
+        shuffleHexagrams(state);
+        buildHexagramOscTable(state);
+        advanceHexagram(state);
+    }
+}
+
+// Rebuild whatever depends on parameter `p`, outside the audio loop
+inline void applyParameterChange(IChingRndState* state, const int16_t* v, int p, float sampleRate) {
+    switch (p) {
+        case kParamScale:
+        case kParamRoot:
+        case kParamTranspose:
+        case kParamMaskRotate:
+        case kParamIntSeqSelect:
+        case kParamIntSeqMod:
+        case kParamIntSeqStart:
+        case kParamIntSeqLen:
+        case kParamIntSeqDir:
+        case kParamIntSeqStride:
+            updateIntSeqPlayback(state, v);
+            // Keep an IntSeq oscillator on the step the cursor is at
+            if (v[kParamClockSource] == 1 && v[kParamOscWave] == 1) {
+                buildIntSeqOscTable(state);
+                state->osc.phase = (state->intseq_pos + 0.5f) / state->osc.steps;
+            }
+            break;
+        case kParamClockSource:
+        case kParamOscWave:
+            if (v[kParamClockSource] == 1)
+                resetOscillator(state, v);
+            break;
+        case kParamGlideMode:
+            if (v[kParamGlideMode] == kGlideOff) {
+                stopGlide(&state->glideCV);
+                stopGlide(&state->glideQuant);
+                stopGlide(&state->glideIntSeq);
+            } else {
+                resumeGlide(&state->glideCV);
+                resumeGlide(&state->glideQuant);
+                resumeGlide(&state->glideIntSeq);
+            }
+            break;
+        case kParamGlideTime:
+            setGlideTime(state, v[kParamGlideTime], sampleRate);
+            break;
+    }
+}
+
+// Writes the held outputs (CV, Quant, IntSeq) and the noise for samples [from, to),
+// during which the hexagram and the IntSeq cursor do not change
+inline void fillHeldOutputs(IChingRndState* state, NoiseState* ns, const int16_t* v, const IChingRndBuses& io,
+                            const int* scaleDegrees, int scaleLen, float sampleRate, int from, int to)
+{
+    int n = to - from;
+    if (n <= 0)
+        return;
+
+    int glideMode = v[kParamGlideMode];
+    int idx = hexagramToIndex(state->hexagram);
+    bool glideHex = ((idx ^ state->glideLastIdx) & v[kParamGlideLines]) != 0;
+    state->glideLastIdx = idx;
+
+    float quant = quantizeResolved(idx / 12.0f, scaleDegrees, scaleLen, v[kParamRoot], v[kParamTranspose], v[kParamMaskRotate]);
+    glideFill(&state->glideCV, hexagramCV(idx), glideHex, glideMode, state->glideSamples, state->glideCoef, io.cvOut + from, n);
+    glideFill(&state->glideQuant, quant, glideHex, glideMode, state->glideSamples, state->glideCoef, io.quantOut + from, n);
+    glideFill(&state->glideIntSeq, state->intseqPlay[state->intseq_pos], true, glideMode, state->glideSamples, state->glideCoef,
+              io.intseqOut + from, n);
+
+    renderNoise(state, ns, v[kParamNoiseType], sampleRate, io.noiseOut + from, n);
+}
+
+// Process one block of `numFrames` samples with parameter values `v`.
+// Clocks, triggers and the oscillator are handled per sample; the held outputs and the noise
+// are filled in runs between the samples where something changes.
+// The random number sequence is consumed in the same order as processBlockReference().
+inline void processBlock(IChingRndState* state, NoiseState* ns, const int16_t* v, const IChingRndBuses& io, int numFrames, float sampleRate)
+{
+    int clockDiv  = v[kParamClockDiv];
+    bool oscMode = v[kParamClockSource] == 1;
+    // Steps at audio rate are a waveform, not events; in Osc mode nothing is published, IntSeqTrig
+    // steps included
+    bool events = !oscMode;
+    bool oscIntSeq = v[kParamOscWave] == 1;
+    float oscPitch = v[kParamOscPitch] / 12.0f;
+
+    // Scale only changes with parameters, resolve it once per block
+    int scaleDegrees[SCALE_MAX_LEN];
+    int scaleLen = 0;
+    resolveScale(v[kParamScale], scaleDegrees, &scaleLen);
+
+    // The IntSeq window and Glide Time are normally resolved in parameterChanged()
+    if (state->intseqPlayLen == 0)
+        updateIntSeqPlayback(state, v);
+    if (state->glideSamples == 0)
+        setGlideTime(state, v[kParamGlideTime], sampleRate);
+    if (oscMode && state->osc.steps == 0)
+        resetOscillator(state, v);
+    float oscInc = oscIncrement(oscPitch, sampleRate);
+
+    int runStart = 0;
+    for (int i = 0; i < numFrames; ++i) {
+        // Oscillator: the phase accumulator replaces the Clock (or IntSeqTrig) input
+        int oscSteps = 0;
+        bool oscWrapped = false;
+        if (oscMode) {
+            if (io.pitchIn)
+                oscInc = oscIncrement(oscPitch + io.pitchIn[i], sampleRate);
+            oscSteps = oscAdvance(&state->osc, oscInc, &oscWrapped);
+        }
+
+        int clock = io.clockIn[i] > 1.0f ? 1 : 0;
+        int clockEdges = (clock && !state->lastClock) ? 1 : 0;
+        if (oscMode && !oscIntSeq) {
+            // Internal clock: high for the first half of each step
+            clock = (state->osc.phase * state->osc.steps - oscStep(&state->osc)) < 0.5f ? 1 : 0;
+            clockEdges = oscSteps;
+        }
+        io.clockThruOut[i] = clock ? 5.0f : 0.0f;
+        state->lastClock = clock;
+        int intseqSteps = (oscMode && oscIntSeq) ? oscSteps : 0;
+
+        // The hexagram (or an oscillator IntSeq step) changes from this sample on
+        if (clockEdges || intseqSteps) {
+            fillHeldOutputs(state, ns, v, io, scaleDegrees, scaleLen, sampleRate, runStart, i);
+            runStart = i;
+        }
+
+        // Clock Divider
+        for (int e = 0; e < clockEdges; ++e) {
+            state->div_counter++;
+            if (state->div_counter >= clockDiv) {
+                state->div_state = 1;
+                state->div_counter = 0;
+                if (events)
+                    publishEvent(&state->events, state->sampleTime + i, kEventDivider, 0, 0, 0);
+            } else {
+                state->div_state = 0;
+            }
+        }
+        io.clockDivOut[i] = state->div_state ? 5.0f : 0.0f;
+
+        // Rising Edge: Hexagram Update
+        for (int e = 0; e < clockEdges; ++e) {
+            int previous = hexagramToIndex(state->hexagram);
+            int idx = advanceHexagram(state);
+            if (events) {
+                float quant = quantizeResolved(idx / 12.0f, scaleDegrees, scaleLen, v[kParamRoot], v[kParamTranspose], v[kParamMaskRotate]);
+                publishEvent(&state->events, state->sampleTime + i, kEventHexagram, idx, idx ^ previous, voltsToMidiNote(quant));
+            }
+        }
+
+        // A new cycle plays the order shuffled at the end of the previous one
+        if (oscMode && !oscIntSeq && oscWrapped)
+            buildHexagramOscTable(state);
+
+        for (int e = 0; e < intseqSteps; ++e)
+            advanceIntSeq(state);
+
+        // An IntSeqTrig edge moves the IntSeq output from the next sample on
+        int intseqTrig = io.intseqTrigIn[i] > 1.0f ? 1 : 0;
+        if (intseqTrig && !state->lastIntSeqTrig && !(oscMode && oscIntSeq)) {
+            fillHeldOutputs(state, ns, v, io, scaleDegrees, scaleLen, sampleRate, runStart, i + 1);
+            runStart = i + 1;
+            advanceIntSeq(state);
+            if (events)
+                publishEvent(&state->events, state->sampleTime + i + 1, kEventIntSeq, 0, 0,
+                             voltsToMidiNote(state->intseqPlay[state->intseq_pos]));
+        }
+        state->lastIntSeqTrig = intseqTrig;
+
+        if (io.oscOut)
+            io.oscOut[i] = oscMode ? oscStepped(&state->osc) : 0.0f;
+        if (io.oscBLOut)
+            io.oscBLOut[i] = oscMode ? oscBandLimited(&state->osc, oscInc) : 0.0f;
+    }
+    fillHeldOutputs(state, ns, v, io, scaleDegrees, scaleLen, sampleRate, runStart, numFrames);
+    state->sampleTime += numFrames;
+}
+
+// --- Snapshot ---
+// The whole running state (RNG, hexagram order and step, IntSeq cursor, divider, oscillator
+// phase and table order, glides and noise filter memories) packed into SNAPSHOT_SIZE bytes,
+// little-endian. The order is reshuffled on the last step of an oscillator cycle but the table
+// only at the wrap, so the table's own order is saved too.
+// Tables that follow from the parameters and from this state are rebuilt on restore, so the
+// engine resumes exactly where it was saved. Event timestamps are not part of it.
+#define SNAPSHOT_VERSION 1
+#define SNAPSHOT_SIZE 213
+
+inline void snapshotPut8(uint8_t*& p, uint32_t x) { *p++ = uint8_t(x); }
+inline void snapshotPut16(uint8_t*& p, uint32_t x) { snapshotPut8(p, x); snapshotPut8(p, x >> 8); }
+inline void snapshotPut32(uint8_t*& p, uint32_t x) { snapshotPut16(p, x); snapshotPut16(p, x >> 16); }
+inline void snapshotPutFloat(uint8_t*& p, float f) {
+    uint32_t x;
+    memcpy(&x, &f, sizeof(x));
+    snapshotPut32(p, x);
+}
+
+inline uint32_t snapshotGet8(const uint8_t*& p) { return *p++; }
+inline uint32_t snapshotGet16(const uint8_t*& p) { uint32_t lo = snapshotGet8(p); return lo | (snapshotGet8(p) << 8); }
+inline uint32_t snapshotGet32(const uint8_t*& p) { uint32_t lo = snapshotGet16(p); return lo | (snapshotGet16(p) << 16); }
+inline float snapshotGetFloat(const uint8_t*& p) {
+    uint32_t x = snapshotGet32(p);
+    float f;
+    memcpy(&f, &x, sizeof(f));
+    return f;
+}
+
+// Writes SNAPSHOT_SIZE bytes to `data`
+inline void saveSnapshot(const IChingRndState* state, const NoiseState* ns, uint8_t* data) {
+    uint8_t* p = data;
+    snapshotPut8(p, SNAPSHOT_VERSION);
+    snapshotPut32(p, state->random);
+    snapshotPut8(p, hexagramToIndex(state->hexagram));
+    snapshotPut8(p, (state->lastClock ? 1 : 0) | (state->lastIntSeqTrig ? 2 : 0) | (state->div_state ? 4 : 0) |
+                    (state->glideCV.active ? 8 : 0) | (state->glideQuant.active ? 16 : 0) | (state->glideIntSeq.active ? 32 : 0));
+    for (int i = 0; i < 64; ++i)
+        snapshotPut8(p, state->hexagramOrder[i]);
+    snapshotPut8(p, state->hexagramStep);
+    snapshotPut16(p, state->intseq_pos);
+    snapshotPut16(p, state->div_counter);
+    snapshotPut8(p, state->glideLastIdx);
+    snapshotPutFloat(p, state->osc.phase);
+    const GlideState* glides[] = { &state->glideCV, &state->glideQuant, &state->glideIntSeq };
+    for (const GlideState* g : glides) {
+        snapshotPutFloat(p, g->value);
+        snapshotPutFloat(p, g->target);
+        snapshotPutFloat(p, g->step);
+        snapshotPut32(p, g->remaining);
+    }
+    for (int i = 0; i < 3; ++i)
+        snapshotPutFloat(p, ns->pink[i]);
+    snapshotPutFloat(p, ns->brown);
+    snapshotPutFloat(p, ns->blueLast);
+    for (int i = 0; i < 64; ++i)
+        snapshotPut8(p, state->oscOrder[i]);
+}
+
+// Restores a snapshot taken by saveSnapshot(), with the parameters `v` already applied.
+// Returns false, leaving the state untouched, when `data` is not a valid snapshot.
+inline bool restoreSnapshot(IChingRndState* state, NoiseState* ns, const int16_t* v, const uint8_t* data, int size) {
+    if (size != SNAPSHOT_SIZE || data[0] != SNAPSHOT_VERSION)
+        return false;
+
+    // The order must be a permutation of the 64 hexagrams
+    const uint8_t* order = data + 7;
+    uint64_t seen = 0;
+    for (int i = 0; i < 64; ++i) {
+        if (order[i] >= 64)
+            return false;
+        seen |= uint64_t(1) << order[i];
+    }
+    if (seen != ~uint64_t(0) || order[64] >= 64 || data[5] >= 64)
+        return false;
+    const uint8_t* oscOrder = data + SNAPSHOT_SIZE - 64;
+    for (int i = 0; i < 64; ++i)
+        if (oscOrder[i] >= 64)
+            return false;
+
+    // xorshift never leaves 0; the phase indexes the oscillator tables; a glide in progress
+    // needs samples left; NaN or infinite filter memories would never recover
+    const uint8_t* p = data + 1;
+    if (snapshotGet32(p) == 0)
+        return false;
+    p = data + 77;  // oscillator phase, then the glides and the noise
+    float phase = snapshotGetFloat(p);
+    if (!(phase >= 0.0f && phase < 1.0f))
+        return false;
+    for (int i = 0; i < 3; ++i) {
+        for (int k = 0; k < 3; ++k)
+            if (!isfinite(snapshotGetFloat(p)))
+                return false;
+        int remaining = int(snapshotGet32(p));
+        bool active = (data[6] >> (3 + i)) & 1;
+        if (remaining < 0 || (active && remaining == 0))
+            return false;
+    }
+    for (int i = 0; i < 5; ++i)
+        if (!isfinite(snapshotGetFloat(p)))
+            return false;
+
+    p = data + 1;
+    state->random = snapshotGet32(p);
+    int idx = snapshotGet8(p);
+    for (int b = 0; b < 6; ++b)
+        state->hexagram[b] = (idx >> b) & 1;
+    uint32_t flags = snapshotGet8(p);
+    state->lastClock = flags & 1;
+    state->lastIntSeqTrig = (flags >> 1) & 1;
+    state->div_state = (flags >> 2) & 1;
+    for (int i = 0; i < 64; ++i)
+        state->hexagramOrder[i] = snapshotGet8(p);
+    state->hexagramStep = snapshotGet8(p);
+    // The cursor indexes the playback buffer, which is not built yet on a restore before the
+    // first block
+    updateIntSeqPlayback(state, v);
+    state->intseq_pos = snapshotGet16(p);
+    if (state->intseq_pos >= state->intseqPlayLen)
+        state->intseq_pos = 0;
+    state->div_counter = snapshotGet16(p);
+    state->glideLastIdx = snapshotGet8(p) & 63;
+    state->osc.phase = snapshotGetFloat(p);
+    GlideState* glides[] = { &state->glideCV, &state->glideQuant, &state->glideIntSeq };
+    for (int i = 0; i < 3; ++i) {
+        glides[i]->value = snapshotGetFloat(p);
+        glides[i]->target = snapshotGetFloat(p);
+        glides[i]->step = snapshotGetFloat(p);
+        glides[i]->remaining = int(snapshotGet32(p));
+        glides[i]->active = (flags >> (3 + i)) & 1;
+    }
+    for (int i = 0; i < 3; ++i)
+        ns->pink[i] = snapshotGetFloat(p);
+    ns->brown = snapshotGetFloat(p);
+    ns->blueLast = snapshotGetFloat(p);
+
+    // Redraw the oscillator table from the restored order (or the IntSeq window)
+    float values[64];
+    for (int i = 0; i < 64; ++i) {
+        state->oscOrder[i] = uint8_t(snapshotGet8(p));
+        values[i] = hexagramOscValue(state->oscOrder[i]);
+    }
+    if (v[kParamClockSource] == 1) {
+        if (v[kParamOscWave] == 1)
+            buildIntSeqOscTable(state);
+        else
+            buildOscTable(&state->osc, values, 64);
+    }
+    return true;
+}
+
+#endif // I_CHING_RND_ENGINE_H
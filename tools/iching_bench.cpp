@@ -0,0 +1,391 @@
+/*
+
+iching_bench.cpp measures the I_Ching_RND engine kernels on the host, both for speed and for
+statistical quality, so a faster RNG or noise kernel can be judged on both in one report.
+Each kernel is timed on its own, away from the Disting NT bus plumbing, and reported in samples/s.
+
+Quality checks:
+ - hexagram order: every aligned 64-clock window holds each hexagram once, and a chi-square of
+   hexagram against position in the window (uniform when the shuffle is unbiased)
+ - bounded draws (advanceRandom() % n for every n the shuffle uses, drawn in shuffle order):
+   measured chi-square and worst bucket deviation in standard errors, plus the modulo bias
+   xorshift32 would have over its full period (a property of that generator, not a measurement)
+ - serial correlation at lag 1 of the raw RNG, white noise and the hexagram sequence
+ - spectral slope of each noise type, from an averaged FFT periodogram
+
+Build and run from the repository root:
+    g++ -O2 -std=c++17 -I. tools/iching_bench.cpp -o iching_bench && ./iching_bench
+
+*/
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <vector>
+
+#include "I_Ching_RND_Engine.h"
+#include "iching_reference.h"
+
+static const int kBlockSize = 256;
+static const int kNumBlocks = 20000;
+static const float kSampleRate = 48000.0f;
+
+// Keeps the optimizer from dropping the results
+static volatile float sink;
+
+// Runs `kernel` (which processes `samplesPerCall` samples) kNumBlocks times and prints its throughput
+template <typename Kernel>
+static void bench(const char* name, int samplesPerCall, Kernel kernel) {
+    kernel(); // warm-up
+    auto start = std::chrono::steady_clock::now();
+    for (int b = 0; b < kNumBlocks; ++b)
+        kernel();
+    auto end = std::chrono::steady_clock::now();
+    double seconds = std::chrono::duration<double>(end - start).count();
+    double samples = double(samplesPerCall) * kNumBlocks;
+    printf("  %-24s %12.3f Msamples/s\n", name, samples / seconds / 1e6);
+}
+
+// Chi-square statistic of `counts` against a uniform expectation
+static double chiSquare(const std::vector<long>& counts, double expected) {
+    double chi = 0.0;
+    for (long c : counts)
+        chi += (c - expected) * (c - expected) / expected;
+    return chi;
+}
+
+// Lag-1 serial correlation
+static double serialCorrelation(const std::vector<double>& x) {
+    double mean = 0.0;
+    for (double v : x) mean += v;
+    mean /= x.size();
+    double num = 0.0, den = 0.0;
+    for (size_t i = 0; i < x.size(); ++i) {
+        den += (x[i] - mean) * (x[i] - mean);
+        if (i + 1 < x.size())
+            num += (x[i] - mean) * (x[i + 1] - mean);
+    }
+    return den > 0.0 ? num / den : 0.0;
+}
+
+// In-place radix-2 FFT, `re.size()` must be a power of two
+static void fft(std::vector<double>& re, std::vector<double>& im) {
+    size_t n = re.size();
+    for (size_t i = 1, j = 0; i < n; ++i) {
+        size_t bit = n >> 1;
+        for (; j & bit; bit >>= 1)
+            j ^= bit;
+        j ^= bit;
+        if (i < j) {
+            std::swap(re[i], re[j]);
+            std::swap(im[i], im[j]);
+        }
+    }
+    for (size_t len = 2; len <= n; len <<= 1) {
+        double w = -2.0 * M_PI / len;
+        for (size_t i = 0; i < n; i += len) {
+            for (size_t k = 0; k < len / 2; ++k) {
+                double c = cos(w * k), s = sin(w * k);
+                size_t a = i + k, b = i + k + len / 2;
+                double tr = re[b] * c - im[b] * s;
+                double ti = re[b] * s + im[b] * c;
+                re[b] = re[a] - tr;
+                im[b] = im[a] - ti;
+                re[a] += tr;
+                im[a] += ti;
+            }
+        }
+    }
+}
+
+// Spectral slope in dB/octave of a noise type, from a Hann-windowed periodogram averaged over
+// `segments` FFTs, fitted by least squares between 100 Hz and 5 kHz
+static double spectralSlope(int noiseType, int segments) {
+    const int n = 4096;
+    IChingRndState state;
+    NoiseState ns;
+    std::vector<float> samples(n);
+    std::vector<double> power(n / 2, 0.0), re(n), im(n);
+
+    // Let the filters settle before measuring
+    for (int i = 0; i < 16; ++i)
+        renderNoise(&state, &ns, noiseType, kSampleRate, samples.data(), n);
+
+    for (int s = 0; s < segments; ++s) {
+        renderNoise(&state, &ns, noiseType, kSampleRate, samples.data(), n);
+        for (int i = 0; i < n; ++i) {
+            double window = 0.5 - 0.5 * cos(2.0 * M_PI * i / (n - 1));
+            re[i] = samples[i] * window;
+            im[i] = 0.0;
+        }
+        fft(re, im);
+        for (int k = 0; k < n / 2; ++k)
+            power[k] += re[k] * re[k] + im[k] * im[k];
+    }
+
+    double sx = 0.0, sy = 0.0, sxx = 0.0, sxy = 0.0;
+    int count = 0;
+    for (int k = 1; k < n / 2; ++k) {
+        double hz = k * kSampleRate / n;
+        if (hz < 100.0 || hz > 5000.0)
+            continue;
+        double x = log2(hz);
+        double y = 10.0 * log10(power[k] / segments);
+        sx += x; sy += y; sxx += x * x; sxy += x * y;
+        ++count;
+    }
+    return (count * sxy - sx * sy) / (count * sxx - sx * sx);
+}
+
+// Block loop throughput, processBlock() against the scalar reference, with a clock every 100 samples
+static void benchBlocks(int glideMode) {
+    static IChingRndState state;
+    NoiseState ns;
+    initOscillator(&state.osc);
+    shuffleHexagrams(&state);
+
+    int16_t v[kNumParams] = { 0 };
+    v[kParamIntSeqMod] = 1;
+    v[kParamIntSeqLen] = 16;
+    v[kParamIntSeqStride] = 1;
+    v[kParamClockDiv] = 2;
+    v[kParamGlideMode] = int16_t(glideMode);
+    v[kParamGlideTime] = 20;
+    v[kParamGlideLines] = 63;
+    for (int p = 0; p < kNumParams; ++p)
+        applyParameterChange(&state, v, p, kSampleRate);
+
+    std::vector<float> clock(kBlockSize), trig(kBlockSize), out[6];
+    for (auto& o : out)
+        o.resize(kBlockSize);
+    IChingRndBuses io = { clock.data(), trig.data(), NULL, out[0].data(), out[1].data(), out[2].data(),
+                          out[3].data(), out[4].data(), out[5].data(), NULL, NULL };
+    int t = 0;
+    auto makeInputs = [&] {
+        for (int i = 0; i < kBlockSize; ++i, ++t) {
+            clock[i] = (t % 100) < 50 ? 5.0f : 0.0f;
+            trig[i] = (t % 300) < 150 ? 5.0f : 0.0f;
+        }
+    };
+
+    if (glideMode == kGlideOff) {
+        bench("block (reference)", kBlockSize, [&] {
+            makeInputs();
+            processBlockReference(&state, &ns, v, io, kBlockSize, kSampleRate);
+            sink = out[0][kBlockSize - 1];
+        });
+    }
+    bench(glideMode == kGlideOff ? "block (processBlock)" : "block (glide linear)", kBlockSize, [&] {
+        makeInputs();
+        processBlock(&state, &ns, v, io, kBlockSize, kSampleRate);
+        sink = out[0][kBlockSize - 1];
+    });
+}
+
+// Hexagram oscillator mode with Osc BL Out connected; the order (and so the table) changes every cycle
+static void benchOscillator(int pitch) {
+    static IChingRndState state;
+    NoiseState ns;
+    state = IChingRndState();
+    initOscillator(&state.osc);
+
+    int16_t v[kNumParams] = { 0 };
+    v[kParamIntSeqMod] = 1;
+    v[kParamIntSeqLen] = 16;
+    v[kParamIntSeqStride] = 1;
+    v[kParamClockDiv] = 2;
+    v[kParamClockSource] = 1;
+    v[kParamOscPitch] = int16_t(pitch);
+    v[kParamGlideTime] = 100;
+    for (int p = 0; p < kNumParams; ++p)
+        applyParameterChange(&state, v, p, kSampleRate);
+
+    std::vector<float> in(kBlockSize, 0.0f), out[8];
+    for (auto& o : out)
+        o.resize(kBlockSize);
+    IChingRndBuses io = { in.data(), in.data(), NULL, out[0].data(), out[1].data(), out[2].data(),
+                          out[3].data(), out[4].data(), out[5].data(), out[6].data(), out[7].data() };
+    char name[32];
+    snprintf(name, sizeof(name), "block (osc %+d st)", pitch);
+    bench(name, kBlockSize, [&] {
+        processBlock(&state, &ns, v, io, kBlockSize, kSampleRate);
+        sink = out[7][kBlockSize - 1];
+    });
+}
+
+static void benchThroughput() {
+    printf("Throughput\n");
+
+    IChingRndState state;
+    shuffleHexagrams(&state);
+    NoiseState ns;
+
+    std::vector<int> indices(kBlockSize);
+    std::vector<float> in(kBlockSize);
+    std::vector<float> out(kBlockSize);
+
+    bench("advanceRandom", kBlockSize, [&] {
+        uint32_t x = 0;
+        for (int i = 0; i < kBlockSize; ++i)
+            x ^= advanceRandom(&state);
+        sink = float(x);
+    });
+
+    bench("shuffleHexagrams", 64, [&] {
+        shuffleHexagrams(&state);
+        sink = float(state.hexagramOrder[0]);
+    });
+
+    bench("hexagram indices", kBlockSize, [&] {
+        generateHexagramIndices(&state, indices.data(), kBlockSize);
+        sink = float(indices[kBlockSize - 1]);
+    });
+
+    for (int i = 0; i < kBlockSize; ++i)
+        in[i] = (i % 64) / 12.0f;
+    bench("quantize (Major)", kBlockSize, [&] {
+        quantizeBlock(in.data(), out.data(), kBlockSize, 0, 0, 0, 0);
+        sink = out[kBlockSize - 1];
+    });
+    bench("quantize (exotic)", kBlockSize, [&] {
+        quantizeBlock(in.data(), out.data(), kBlockSize, NUM_STANDARD_SCALES + 9, 0, 0, 0);
+        sink = out[kBlockSize - 1];
+    });
+
+    static const char* noiseNames[] = { "noise White", "noise Pink", "noise Brown", "noise Blue" };
+    for (int type = 0; type < 4; ++type) {
+        bench(noiseNames[type], kBlockSize, [&] {
+            renderNoise(&state, &ns, type, kSampleRate, out.data(), kBlockSize);
+            sink = out[kBlockSize - 1];
+        });
+    }
+
+    benchBlocks(kGlideOff);
+    benchBlocks(kGlideLinear);
+    benchOscillator(0);
+    benchOscillator(24);
+    benchOscillator(48);
+}
+
+static void reportHexagramOrder() {
+    const int cycles = 64000;
+    IChingRndState state;
+    shuffleHexagrams(&state);
+
+    // counts[position * 64 + hexagram]
+    std::vector<long> counts(64 * 64, 0);
+    std::vector<double> sequence;
+    sequence.reserve(size_t(cycles) * 64);
+    int complete = 0;
+    for (int c = 0; c < cycles; ++c) {
+        uint64_t seen = 0;
+        for (int p = 0; p < 64; ++p) {
+            int idx = advanceHexagram(&state);
+            seen |= uint64_t(1) << idx;
+            counts[p * 64 + idx]++;
+            sequence.push_back(idx);
+        }
+        if (seen == ~uint64_t(0))
+            ++complete;
+    }
+
+    double chi = chiSquare(counts, cycles / 64.0);
+    int dof = 63 * 63;
+    printf("  %-24s %d / %d windows hold all 64\n", "64-clock coverage", complete, cycles);
+    printf("  %-24s chi2 %.1f, dof %d, z %+.2f\n", "position x hexagram", chi, dof, (chi - dof) / sqrt(2.0 * dof));
+    printf("  %-24s %+.5f\n", "hexagram lag-1 corr", serialCorrelation(sequence));
+}
+
+// Largest relative deviation from uniform of x % n, x taken once over 1 .. 2^32-1: the bias of
+// xorshift32 over its full period. Worked out, not measured; it says nothing about another RNG.
+static double xorshiftModuloBias(int n) {
+    const uint64_t period = 0xFFFFFFFFull;
+    double expected = double(period) / n;
+    double worst = 0.0;
+    for (int r = 0; r < n; ++r) {
+        uint64_t count = r == 0 ? period / n : (period - r) / n + 1;
+        worst = fmax(worst, fabs(double(count) - expected) / expected);
+    }
+    return worst;
+}
+
+static void reportBoundedDraws() {
+    // Measured: the draws of many Fisher-Yates shuffles, one histogram per bound (% 2 .. % 64)
+    const int shuffles = 400000;
+    IChingRndState state;
+    std::vector<std::vector<long>> counts(65);
+    for (int n = 2; n <= 64; ++n)
+        counts[n].assign(n, 0);
+    for (int s = 0; s < shuffles; ++s)
+        for (int i = 63; i > 0; --i)
+            counts[i + 1][advanceRandom(&state) % (i + 1)]++;
+
+    double chi = 0.0, worstSigma = 0.0;
+    int dof = 0, worstBound = 2;
+    for (int n = 2; n <= 64; ++n) {
+        double expected = double(shuffles) / n;
+        double sigma = sqrt(expected * (1.0 - 1.0 / n));
+        chi += chiSquare(counts[n], expected);
+        dof += n - 1;
+        for (long c : counts[n]) {
+            if (fabs(c - expected) / sigma > worstSigma) {
+                worstSigma = fabs(c - expected) / sigma;
+                worstBound = n;
+            }
+        }
+    }
+    printf("  %-24s chi2 %.1f, dof %d, z %+.2f\n", "shuffle draws % 2..64", chi, dof, (chi - dof) / sqrt(2.0 * dof));
+    printf("  %-24s %.2f sigma (at %% %d), of %d buckets\n", "worst bucket", worstSigma, worstBound, dof + 63);
+
+    double bias = 0.0;
+    int biasBound = 2;
+    for (int n = 2; n <= 64; ++n) {
+        if (xorshiftModuloBias(n) > bias) {
+            bias = xorshiftModuloBias(n);
+            biasBound = n;
+        }
+    }
+    printf("  %-24s %.3g (at %% %d), analytic for a full-period xorshift32\n", "modulo bias", bias, biasBound);
+}
+
+static void reportSerialCorrelation() {
+    const int n = 1 << 20;
+    IChingRndState state;
+    std::vector<double> raw(n);
+    for (int i = 0; i < n; ++i)
+        raw[i] = advanceRandom(&state) / 4294967296.0;
+    printf("  %-24s %+.5f\n", "advanceRandom lag-1", serialCorrelation(raw));
+
+    std::vector<double> white(n);
+    for (int i = 0; i < n; ++i)
+        white[i] = whiteNoise(&state);
+    printf("  %-24s %+.5f\n", "white noise lag-1", serialCorrelation(white));
+}
+
+static void reportSpectra() {
+    static const char* noiseNames[] = { "White", "Pink", "Brown", "Blue" };
+    static const double expected[] = { 0.0, -3.0, -6.0, 3.0 };
+    for (int type = 0; type < 4; ++type) {
+        char name[32];
+        snprintf(name, sizeof(name), "slope %s", noiseNames[type]);
+        printf("  %-24s %+6.2f dB/oct (ideal %+.0f)\n", name, spectralSlope(type, 64), expected[type]);
+    }
+}
+
+int main() {
+    benchThroughput();
+
+    printf("\nHexagram order\n");
+    reportHexagramOrder();
+
+    printf("\nBounded draws\n");
+    reportBoundedDraws();
+
+    printf("\nSerial correlation\n");
+    reportSerialCorrelation();
+
+    printf("\nNoise spectra (100 Hz - 5 kHz)\n");
+    reportSpectra();
+
+    return 0;
+}
@@ -0,0 +1,667 @@
+/*
+
+iching_diff.cpp is a differential test of processBlock() against the scalar reference loop in
+tools/iching_reference.h. Both are fed the same seeds and the same randomized Clock, IntSeqTrig,
+Pitch and parameter streams, and every output bus is compared sample by sample: bit-exact, except
+for the outputs listed with a tolerance below. The first divergence is shrunk to a minimal
+reproducer (fewest blocks, inputs and parameter changes) before it is printed.
+CV, Quant and IntSeq Out go through the glide stage, which the reference does not have: they are
+compared with a per-sample slew model fed by the reference's stepped outputs, which with Glide off
+passes them through unchanged.
+In half of the scenarios processBlock() is also saved with saveSnapshot() and restored into a
+freshly constructed state part way through, with or without the parameters applied first, which
+must not change any of its outputs; corrupt snapshots must be rejected without touching the state.
+
+Build and run from the repository root:
+    g++ -O2 -std=c++17 -I. tools/iching_diff.cpp -o iching_diff && ./iching_diff [scenarios] [seed]
+
+*/
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+#include "I_Ching_RND_Engine.h"
+#include "iching_reference.h"
+
+static const float kSampleRate = 48000.0f;
+
+// --- Outputs under test ---
+enum {
+    kOutCV,
+    kOutQuant,
+    kOutIntSeq,
+    kOutNoise,
+    kOutClockThru,
+    kOutClockDiv,
+    kOutOsc,
+    kOutOscBL,
+    kNumOutputs
+};
+
+static const char* outputNames[kNumOutputs] = {
+    "CV Out", "Quant Out", "IntSeq Out", "Noise Out", "Clock Thru Out", "Clock Div Out", "Osc Out", "Osc BL Out"
+};
+
+// Largest accepted difference per output; 0 means bit-exact
+static const float outputTolerance[kNumOutputs] = {
+    0.0f, 0.0f, 0.0f, 1e-5f, 0.0f, 0.0f, 0.0f, 1e-4f
+};
+
+// Largest accepted difference of a glided output during a glide: the model accumulates the
+// linear ramp sample by sample, processBlock() computes it from the start of each block
+static const float kGlideTolerance = 5e-4f;
+
+// --- Parameter ranges (matching the parameters table of the plugin) ---
+struct ParamRange {
+    const char* name;
+    int min, max, def;
+};
+
+static const ParamRange paramRanges[kNumParams] = {
+    { "Clock In", 1, 28, 1 },
+    { "IntSeqTrig In", 1, 28, 2 },
+    { "CV Out", 1, 28, 13 },
+    { "Quant Out", 1, 28, 14 },
+    { "IntSeq Out", 1, 28, 15 },
+    { "Noise Out", 1, 28, 16 },
+    { "Clock Thru Out", 1, 28, 17 },
+    { "Clock Div Out", 1, 28, 18 },
+    { "Scale", 0, NUM_SCALES - 1, 0 },
+    { "Root", 0, 11, 0 },
+    { "Transpose", -24, 24, 0 },
+    { "MaskRot", 0, 15, 0 },
+    { "IntSeq", 0, NUM_INTSEQ - 1, 0 },
+    { "IntSeqMod", 1, 32, 1 },
+    { "IntSeqStart", 0, 126, 0 },
+    { "IntSeqLen", 1, 128, 16 },
+    { "IntSeqDir", 0, 1, 0 },
+    { "IntSeqStride", 1, 16, 1 },
+    { "Noise Type", 0, 3, 0 },
+    { "Clock Div", 2, 512, 2 },
+    { "Clock Src", 0, 1, 0 },
+    { "Osc Wave", 0, 1, 0 },
+    { "Osc Pitch", -48, 48, 0 },
+    { "Pitch In", 0, 28, 0 },
+    { "Osc Out", 0, 28, 0 },
+    { "Osc BL Out", 0, 28, 0 },
+    { "Glide", 0, 2, 0 },
+    { "Glide Time", 1, 5000, 100 },
+    { "Glide Lines", 0, 63, 63 },
+    { "MIDI Out", 0, 3, 0 },
+    { "MIDI Ch", 1, 16, 1 },
+};
+
+// Parameters the scenarios change; bus assignments only matter as connected or not
+static const int kRoutingParams = kParamClockDivOut + 1;
+
+// --- Scenarios ---
+struct Block {
+    int numFrames;
+    int16_t v[kNumParams];
+    std::vector<float> clock;
+    std::vector<float> trig;
+    std::vector<float> pitch;
+};
+
+struct Scenario {
+    uint32_t seed;
+    std::vector<Block> blocks;
+    int restoreBlock;   // processBlock() resumes from a snapshot before this block, -1 for none
+};
+
+// Scenario generator RNG, kept apart from the engine's
+struct Dice {
+    uint32_t x;
+    uint32_t next() { x ^= x << 13; x ^= x >> 17; x ^= x << 5; return x; }
+    int range(int lo, int hi) { return lo + int(next() % uint32_t(hi - lo + 1)); }
+    bool chance(int percent) { return range(0, 99) < percent; }
+};
+
+static void randomizeParam(Dice& dice, int16_t* v, int p) {
+    const ParamRange& r = paramRanges[p];
+    // Mostly glides short enough to finish (across a few blocks) within a scenario
+    if (p == kParamGlideTime && dice.chance(80))
+        v[p] = int16_t(dice.range(1, 20));
+    else if (p == kParamPitchIn || p == kParamOscOut || p == kParamOscBLOut)
+        v[p] = dice.chance(70) ? 1 : 0;
+    else
+        v[p] = int16_t(dice.range(r.min, r.max));
+}
+
+// Gate stream with a random period and duty cycle, plus occasional glitches
+static void fillGate(Dice& dice, std::vector<float>& out, int n, int& phase, int period, int duty) {
+    out.resize(n);
+    for (int i = 0; i < n; ++i) {
+        out[i] = (phase % period) < duty ? 5.0f : 0.0f;
+        if (dice.chance(1))
+            out[i] = 5.0f - out[i];
+        ++phase;
+    }
+}
+
+static Scenario makeScenario(uint32_t seed) {
+    Dice dice = { seed * 2654435761u + 1 };
+    Scenario sc;
+    sc.seed = seed;
+
+    int16_t v[kNumParams];
+    for (int p = 0; p < kNumParams; ++p)
+        v[p] = int16_t(paramRanges[p].def);
+    for (int p = kRoutingParams; p < kNumParams; ++p)
+        if (dice.chance(60))
+            randomizeParam(dice, v, p);
+    if (dice.chance(40))
+        v[kParamClockDiv] = int16_t(dice.range(2, 8));
+
+    int clockPhase = 0, trigPhase = 0;
+    int clockPeriod = dice.range(2, 200), clockDuty = dice.range(1, clockPeriod - 1 > 0 ? clockPeriod - 1 : 1);
+    int trigPeriod = dice.range(2, 200), trigDuty = dice.range(1, trigPeriod - 1 > 0 ? trigPeriod - 1 : 1);
+    float pitch = float(dice.range(-200, 200)) / 100.0f;
+
+    int numBlocks = dice.range(8, 40);
+    for (int b = 0; b < numBlocks; ++b) {
+        if (b > 0 && dice.chance(25)) {
+            int changes = dice.range(1, 2);
+            for (int c = 0; c < changes; ++c)
+                randomizeParam(dice, v, dice.range(kRoutingParams, kNumParams - 1));
+        }
+        Block block;
+        block.numFrames = 4 * dice.range(1, 64);
+        for (int p = 0; p < kNumParams; ++p)
+            block.v[p] = v[p];
+        fillGate(dice, block.clock, block.numFrames, clockPhase, clockPeriod, clockDuty);
+        fillGate(dice, block.trig, block.numFrames, trigPhase, trigPeriod, trigDuty);
+        block.pitch.resize(block.numFrames);
+        for (int i = 0; i < block.numFrames; ++i) {
+            pitch += float(dice.range(-100, 100)) / 10000.0f;
+            block.pitch[i] = pitch;
+        }
+        sc.blocks.push_back(block);
+    }
+    sc.restoreBlock = dice.chance(50) ? dice.range(1, numBlocks - 1) : -1;
+    return sc;
+}
+
+// --- Running ---
+struct Divergence {
+    bool found;
+    int block;
+    int frame;
+    int output;
+    float expected;
+    float actual;
+};
+
+// Buffers for one implementation's outputs
+struct Outputs {
+    std::vector<float> bus[kNumOutputs];
+
+    IChingRndBuses buses(const Block& block, int n) {
+        for (int o = 0; o < kNumOutputs; ++o)
+            bus[o].assign(n, -99.0f);
+        IChingRndBuses io;
+        io.clockIn = block.clock.data();
+        io.intseqTrigIn = block.trig.data();
+        io.pitchIn = block.v[kParamPitchIn] ? block.pitch.data() : NULL;
+        io.cvOut = bus[kOutCV].data();
+        io.quantOut = bus[kOutQuant].data();
+        io.intseqOut = bus[kOutIntSeq].data();
+        io.noiseOut = bus[kOutNoise].data();
+        io.clockThruOut = bus[kOutClockThru].data();
+        io.clockDivOut = bus[kOutClockDiv].data();
+        io.oscOut = block.v[kParamOscOut] ? bus[kOutOsc].data() : NULL;
+        io.oscBLOut = block.v[kParamOscBLOut] ? bus[kOutOscBL].data() : NULL;
+        return io;
+    }
+};
+
+// Bus pointers advanced to frame `i`
+static IChingRndBuses offsetBuses(IChingRndBuses io, int i) {
+    io.clockIn += i;
+    io.intseqTrigIn += i;
+    if (io.pitchIn)
+        io.pitchIn += i;
+    io.cvOut += i;
+    io.quantOut += i;
+    io.intseqOut += i;
+    io.noiseOut += i;
+    io.clockThruOut += i;
+    io.clockDivOut += i;
+    if (io.oscOut)
+        io.oscOut += i;
+    if (io.oscBLOut)
+        io.oscBLOut += i;
+    return io;
+}
+
+static void initState(IChingRndState* state, NoiseState* ns, uint32_t seed) {
+    *state = IChingRndState();
+    *ns = NoiseState();
+    initOscillator(&state->osc);
+    state->random = seed ? seed : 1;
+    shuffleHexagrams(state);
+}
+
+// --- Glide model ---
+// Per-sample slew toward the stepped value, the behaviour glideFill() implements block-wise
+struct SlewModel {
+    float value = 0.0f;
+    float target = 0.0f;
+    double step = 0.0;
+    double ramp = 0.0;    // linear: ramp value, kept in double so only processBlock() rounds
+    int remaining = 0;
+    bool active = false;
+
+    float next(float newTarget, bool glide, int mode, int glideSamples, float glideCoef) {
+        if (newTarget != target) {
+            target = newTarget;
+            if (glide && mode != kGlideOff) {
+                active = true;
+                remaining = glideSamples;
+                ramp = value;
+                step = (double(target) - value) / glideSamples;
+            } else {
+                value = target;
+                active = false;
+            }
+        }
+        if (!active)
+            return value;
+        if (mode == kGlideExp) {
+            value += (target - value) * glideCoef;
+            if (fabsf(target - value) < 1e-4f)
+                active = false;
+        } else {
+            ramp += step;
+            value = float(ramp);
+            --remaining;
+            if (remaining == 0)
+                active = false;
+        }
+        if (!active)
+            value = target;
+        return value;
+    }
+
+    // Glide mode changed: Off jumps to the target, a linear ramp resumes over the samples left
+    void modeChanged(int mode) {
+        if (mode == kGlideOff) {
+            value = target;
+            active = false;
+        } else if (active) {
+            ramp = value;
+            step = (double(target) - value) / remaining;
+        }
+    }
+};
+
+// Saves `state` and restores it into a freshly constructed state with the parameters `v`,
+// as loading a preset does. For odd seeds the restore comes before any parameter change, so
+// nothing derived from the parameters (IntSeq playback, oscillator table) is built yet.
+static void reloadState(IChingRndState* state, NoiseState* ns, const int16_t* v, uint32_t seed) {
+    uint8_t data[SNAPSHOT_SIZE];
+    saveSnapshot(state, ns, data);
+    initState(state, ns, seed * 2654435761u);
+    if (!(seed & 1))
+        for (int p = 0; p < kNumParams; ++p)
+            applyParameterChange(state, v, p, kSampleRate);
+    if (!restoreSnapshot(state, ns, v, data, SNAPSHOT_SIZE)) {
+        printf("restoreSnapshot() rejected a snapshot taken by saveSnapshot()\n");
+        exit(1);
+    }
+}
+
+static Divergence runScenario(const Scenario& sc, long* samplesCompared) {
+    static IChingRndState ref, opt;
+    NoiseState nsRef, nsOpt;
+    initReference(&ref, &nsRef, sc.seed);
+    initState(&opt, &nsOpt, sc.seed);
+
+    Outputs outRef, outOpt;
+    SlewModel slews[3];   // CV, Quant, IntSeq Out
+    bool gliding[3][256];
+    int lastIdx = 0;
+    Divergence d = { false, 0, 0, 0, 0.0f, 0.0f };
+    for (size_t b = 0; b < sc.blocks.size(); ++b) {
+        const Block& block = sc.blocks[b];
+        for (int p = 0; p < kNumParams; ++p) {
+            if (b == 0 || sc.blocks[b - 1].v[p] != block.v[p]) {
+                applyParameterChangeReference(&ref, block.v, p);
+                applyParameterChange(&opt, block.v, p, kSampleRate);
+                if (p == kParamGlideMode)
+                    for (SlewModel& s : slews)
+                        s.modeChanged(block.v[p]);
+            }
+        }
+        if (int(b) == sc.restoreBlock)
+            reloadState(&opt, &nsOpt, block.v, sc.seed);
+
+        int glideMode = block.v[kParamGlideMode];
+        int glideSamples = int(block.v[kParamGlideTime] * 0.001f * kSampleRate);
+        glideSamples = glideSamples > 1 ? glideSamples : 1;
+        float glideCoef = 1.0f - expf(-4.6f / glideSamples);
+
+        // The reference runs one sample at a time, so the model sees every hexagram change
+        static const int glided[3] = { kOutCV, kOutQuant, kOutIntSeq };
+        IChingRndBuses ioRef = outRef.buses(block, block.numFrames);
+        for (int i = 0; i < block.numFrames; ++i) {
+            processBlockReference(&ref, &nsRef, block.v, offsetBuses(ioRef, i), 1, kSampleRate);
+            int idx = refHexagramIndex(ref.hexagram);
+            bool glideHex = ((idx ^ lastIdx) & block.v[kParamGlideLines]) != 0;
+            lastIdx = idx;
+            for (int k = 0; k < 3; ++k) {
+                float& out = outRef.bus[glided[k]][i];
+                out = slews[k].next(out, k == 2 || glideHex, glideMode, glideSamples, glideCoef);
+                gliding[k][i] = slews[k].active;
+            }
+        }
+
+        IChingRndBuses ioOpt = outOpt.buses(block, block.numFrames);
+        processBlock(&opt, &nsOpt, block.v, ioOpt, block.numFrames, kSampleRate);
+
+        for (int i = 0; i < block.numFrames; ++i) {
+            for (int o = 0; o < kNumOutputs; ++o) {
+                float e = outRef.bus[o][i], a = outOpt.bus[o][i];
+                float tolerance = outputTolerance[o];
+                if (o <= kOutIntSeq && gliding[o][i])
+                    tolerance = kGlideTolerance;
+                bool same = tolerance == 0.0f ? e == a : fabsf(e - a) <= tolerance;
+                if (!same) {
+                    d = { true, int(b), i, o, e, a };
+                    return d;
+                }
+            }
+        }
+        if (samplesCompared)
+            *samplesCompared += block.numFrames;
+    }
+    return d;
+}
+
+// --- Shrinking ---
+// Greedily simplifies a diverging scenario while it keeps diverging
+static Scenario shrink(Scenario sc) {
+    Divergence d = runScenario(sc, NULL);
+    sc.blocks.resize(d.block + 1);
+
+    bool progress = true;
+    while (progress) {
+        progress = false;
+
+        // Drop whole blocks
+        for (size_t b = 0; b < sc.blocks.size() && sc.blocks.size() > 1; ) {
+            Scenario trial = sc;
+            trial.blocks.erase(trial.blocks.begin() + b);
+            if (runScenario(trial, NULL).found) {
+                sc = trial;
+                progress = true;
+            } else {
+                ++b;
+            }
+        }
+
+        for (size_t b = 0; b < sc.blocks.size(); ++b) {
+            // Silence inputs
+            std::vector<float> Block::* inputs[] = { &Block::clock, &Block::trig, &Block::pitch };
+            for (auto input : inputs) {
+                Scenario trial = sc;
+                std::vector<float>& samples = trial.blocks[b].*input;
+                bool silent = true;
+                for (float& s : samples) {
+                    silent = silent && s == 0.0f;
+                    s = 0.0f;
+                }
+                if (!silent && runScenario(trial, NULL).found) {
+                    sc = trial;
+                    progress = true;
+                }
+            }
+
+            // Drop single gate pulses
+            std::vector<float> Block::* gates[] = { &Block::clock, &Block::trig };
+            for (auto gate : gates) {
+                for (int start = 0; start < sc.blocks[b].numFrames; ) {
+                    const std::vector<float>& samples = sc.blocks[b].*gate;
+                    if (samples[start] == 0.0f) {
+                        ++start;
+                        continue;
+                    }
+                    int end = start;
+                    while (end < sc.blocks[b].numFrames && samples[end] != 0.0f)
+                        ++end;
+                    Scenario trial = sc;
+                    std::vector<float>& trialSamples = trial.blocks[b].*gate;
+                    for (int i = start; i < end; ++i)
+                        trialSamples[i] = 0.0f;
+                    if (runScenario(trial, NULL).found) {
+                        sc = trial;
+                        progress = true;
+                    }
+                    start = end;
+                }
+            }
+
+            // Undo parameter changes (back to the previous block, or to the default)
+            for (int p = kRoutingParams; p < kNumParams; ++p) {
+                int16_t base = b == 0 ? int16_t(paramRanges[p].def) : sc.blocks[b - 1].v[p];
+                if (sc.blocks[b].v[p] == base)
+                    continue;
+                Scenario trial = sc;
+                for (size_t k = b; k < trial.blocks.size() && trial.blocks[k].v[p] == sc.blocks[b].v[p]; ++k)
+                    trial.blocks[k].v[p] = base;
+                if (runScenario(trial, NULL).found) {
+                    sc = trial;
+                    progress = true;
+                }
+            }
+
+            // Shorten blocks
+            while (sc.blocks[b].numFrames > 4) {
+                Scenario trial = sc;
+                Block& block = trial.blocks[b];
+                block.numFrames -= 4;
+                block.clock.resize(block.numFrames);
+                block.trig.resize(block.numFrames);
+                block.pitch.resize(block.numFrames);
+                if (!runScenario(trial, NULL).found)
+                    break;
+                sc = trial;
+                progress = true;
+            }
+        }
+    }
+    return sc;
+}
+
+// Prints the rising edges of a gate stream
+static void printEdges(const char* name, const std::vector<float>& samples, float previous) {
+    printf("    %-6s rising at", name);
+    int count = 0;
+    for (size_t i = 0; i < samples.size(); ++i) {
+        if (samples[i] > 1.0f && !(previous > 1.0f)) {
+            printf(" %d", int(i));
+            ++count;
+        }
+        previous = samples[i];
+    }
+    printf(count ? "\n" : " (none)\n");
+}
+
+static void printReproducer(const Scenario& sc) {
+    Divergence d = runScenario(sc, NULL);
+    printf("Reproducer: seed %u, %d block(s)\n", sc.seed, int(sc.blocks.size()));
+    for (size_t b = 0; b < sc.blocks.size(); ++b) {
+        const Block& block = sc.blocks[b];
+        printf("  block %d: %d frames%s\n", int(b), block.numFrames,
+               int(b) == sc.restoreBlock ? ", processBlock restored from a snapshot" : "");
+        for (int p = kRoutingParams; p < kNumParams; ++p) {
+            int16_t base = b == 0 ? int16_t(paramRanges[p].def) : sc.blocks[b - 1].v[p];
+            if (block.v[p] != base)
+                printf("    %s = %d\n", paramRanges[p].name, block.v[p]);
+        }
+        float lastClock = b == 0 ? 0.0f : sc.blocks[b - 1].clock.back();
+        float lastTrig = b == 0 ? 0.0f : sc.blocks[b - 1].trig.back();
+        printEdges("Clock", block.clock, lastClock);
+        printEdges("Trig", block.trig, lastTrig);
+        if (block.v[kParamPitchIn])
+            printf("    Pitch  %.4f V .. %.4f V\n", block.pitch.front(), block.pitch.back());
+    }
+    printf("  %s differs at block %d, frame %d: reference %.9g, processBlock %.9g\n",
+           outputNames[d.output], d.block, d.frame, d.expected, d.actual);
+}
+
+// Corrupt snapshots are rejected and leave the state as it was
+static bool checkCorruptSnapshots() {
+    static IChingRndState state;
+    NoiseState ns;
+    Block block;
+    for (int p = 0; p < kNumParams; ++p)
+        block.v[p] = int16_t(paramRanges[p].def);
+    block.v[kParamGlideMode] = kGlideLinear;
+    initState(&state, &ns, 1);
+    for (int p = 0; p < kNumParams; ++p)
+        applyParameterChange(&state, block.v, p, kSampleRate);
+
+    // Mid-glide, so the snapshot holds glides in progress and live noise memories
+    block.numFrames = 256;
+    block.clock.assign(256, 0.0f);
+    block.trig.assign(256, 0.0f);
+    block.clock[10] = 5.0f;
+    block.trig[20] = 5.0f;
+    Outputs outputs;
+    processBlock(&state, &ns, block.v, outputs.buses(block, 256), 256, kSampleRate);
+    GlideState* glides[] = { &state.glideCV, &state.glideQuant, &state.glideIntSeq };
+    for (GlideState* g : glides) {
+        if (!g->active) {
+            g->active = true;
+            g->remaining = 100;
+            g->target = g->value + 1.0f;
+            g->step = 0.01f;
+        }
+    }
+
+    uint8_t good[SNAPSHOT_SIZE];
+    saveSnapshot(&state, &ns, good);
+
+    struct Corruption {
+        const char* name;
+        int offset;
+        int bytes;
+        uint32_t value;
+    };
+    const uint32_t nan = 0x7FC00000, inf = 0x7F800000, minusTenth = 0xBDCCCCCD, one = 0x3F800000;
+    static const int kPhase = 77, kGlides = 81, kNoise = 129;
+    const Corruption corruptions[] = {
+        { "version", 0, 1, SNAPSHOT_VERSION + 1 },
+        { "RNG stuck at 0", 1, 4, 0 },
+        { "hexagram order with a repeat", 7, 1, good[8] },
+        { "hexagram step past 63", 71, 1, 64 },
+        { "oscillator table order past 63", SNAPSHOT_SIZE - 1, 1, 64 },
+        { "NaN phase", kPhase, 4, nan },
+        { "negative phase", kPhase, 4, minusTenth },
+        { "phase of 1", kPhase, 4, one },
+        { "infinite CV glide value", kGlides, 4, inf },
+        { "NaN Quant glide target", kGlides + 16 + 4, 4, nan },
+        { "infinite IntSeq glide step", kGlides + 32 + 8, 4, inf },
+        { "active CV glide with no samples left", kGlides + 12, 4, 0 },
+        { "negative glide length", kGlides + 16 + 12, 4, 0xFFFFFFFF },
+        { "NaN pink noise memory", kNoise, 4, nan },
+        { "infinite brown noise memory", kNoise + 12, 4, inf },
+    };
+    bool ok = true;
+    for (const Corruption& c : corruptions) {
+        uint8_t bad[SNAPSHOT_SIZE];
+        memcpy(bad, good, SNAPSHOT_SIZE);
+        for (int k = 0; k < c.bytes; ++k)
+            bad[c.offset + k] = uint8_t(c.value >> (8 * k));
+
+        uint8_t before[SNAPSHOT_SIZE], after[SNAPSHOT_SIZE];
+        saveSnapshot(&state, &ns, before);
+        bool accepted = restoreSnapshot(&state, &ns, block.v, bad, SNAPSHOT_SIZE);
+        saveSnapshot(&state, &ns, after);
+        if (accepted || memcmp(before, after, SNAPSHOT_SIZE) != 0) {
+            printf("Corrupt snapshot (%s) %s\n", c.name, accepted ? "accepted" : "changed the state");
+            ok = false;
+        }
+    }
+    if (restoreSnapshot(&state, &ns, block.v, good, SNAPSHOT_SIZE - 1)) {
+        printf("Short snapshot accepted\n");
+        ok = false;
+    }
+    if (!restoreSnapshot(&state, &ns, block.v, good, SNAPSHOT_SIZE)) {
+        printf("Valid snapshot rejected\n");
+        ok = false;
+    }
+    return ok;
+}
+
+// Glide Time: a linear glide lands on its target after Glide Time, an exponential one is then
+// within 1% of it, and processBlock() resolves Glide Time itself before any parameter change
+static bool checkGlideTime() {
+    static const int times[] = { 1, 5, 100, 1000, 5000 };
+    std::vector<float> out;
+    for (int ms : times) {
+        IChingRndState state;
+        setGlideTime(&state, ms, kSampleRate);
+        int n = state.glideSamples;
+        out.resize(n + 1);
+
+        GlideState linear;
+        glideFill(&linear, 1.0f, true, kGlideLinear, n, state.glideCoef, out.data(), n + 1);
+        if (n != int(ms * 0.001f * kSampleRate) || out[n - 1] != 1.0f || (n > 1 && out[n - 2] >= 1.0f)) {
+            printf("Glide Time %d ms: linear glide does not take %d samples\n", ms, n);
+            return false;
+        }
+
+        GlideState exponential;
+        glideFill(&exponential, 1.0f, true, kGlideExp, n, state.glideCoef, out.data(), n);
+        float left = 1.0f - out[n - 1];
+        if (n > 100 && (left < 0.009f || left > 0.011f)) {
+            printf("Glide Time %d ms: exponential glide is %.4f%% short after %d samples, not 1%%\n", ms, 100.0f * left, n);
+            return false;
+        }
+    }
+
+    // No parameterChanged() yet: the default Glide Time applies
+    static IChingRndState state;
+    NoiseState ns;
+    Block block;
+    int16_t* v = block.v;
+    for (int p = 0; p < kNumParams; ++p)
+        v[p] = int16_t(paramRanges[p].def);
+    block.numFrames = 4;
+    block.clock.assign(4, 0.0f);
+    block.trig.assign(4, 0.0f);
+    Outputs outputs;
+    processBlock(&state, &ns, v, outputs.buses(block, 4), 4, kSampleRate);
+    if (state.glideSamples != int(paramRanges[kParamGlideTime].def * 0.001f * kSampleRate)) {
+        printf("Glide Time is not resolved before the first parameter change\n");
+        return false;
+    }
+    return true;
+}
+
+int main(int argc, char** argv) {
+    int scenarios = argc > 1 ? atoi(argv[1]) : 500;
+    uint32_t baseSeed = argc > 2 ? uint32_t(strtoul(argv[2], NULL, 0)) : 1;
+
+    if (!checkGlideTime() || !checkCorruptSnapshots())
+        return 1;
+
+    long samples = 0;
+    for (int s = 0; s < scenarios; ++s) {
+        Scenario sc = makeScenario(baseSeed + s);
+        Divergence d = runScenario(sc, &samples);
+        if (d.found) {
+            printf("Scenario %d (seed %u): %s differs at block %d, frame %d\n",
+                   s, sc.seed, outputNames[d.output], d.block, d.frame);
+            printReproducer(shrink(sc));
+            return 1;
+        }
+    }
+    printf("%d scenarios, %ld samples: processBlock matches the reference on every output\n", scenarios, samples);
+    return 0;
+}
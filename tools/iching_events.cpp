@@ -0,0 +1,274 @@
+/*
+
+iching_events.cpp checks the event queue published by processBlock() and the MIDI output built
+from it:
+ - the events read back are the expected ones, in publish order: type, timestamp, hexagram
+   index, changed lines and note, worked out from the inputs and a twin engine run sample by sample
+ - in Osc mode nothing is published, IntSeqTrig steps included
+ - a reader that falls behind counts what it missed, then resumes from the oldest intact event,
+   also across the wrap of the 32-bit write index
+ - collectMidi() coalesces a block into one note, the latest CC values and one divider pulse,
+   and releases the held note when the output is re-routed or switched off
+
+Build and run from the repository root:
+    g++ -O2 -std=c++17 -I. tools/iching_events.cpp -o iching_events && ./iching_events
+
+*/
+
+#include <cstdio>
+#include <vector>
+
+#include "I_Ching_RND_Engine.h"
+
+static const float kSampleRate = 48000.0f;
+
+static int failures = 0;
+
+static void check(bool ok, const char* what) {
+    if (!ok) {
+        printf("FAIL: %s\n", what);
+        ++failures;
+    }
+}
+
+static bool sameEvent(const IChingEvent& a, const IChingEvent& b) {
+    return a.time == b.time && a.type == b.type && a.hexagram == b.hexagram && a.lines == b.lines && a.note == b.note;
+}
+
+static void initEngine(IChingRndState* state, int16_t* v) {
+    *state = IChingRndState();
+    initOscillator(&state->osc);
+    shuffleHexagrams(state);
+    for (int p = 0; p < kNumParams; ++p)
+        v[p] = 0;
+    v[kParamIntSeqMod] = 1;
+    v[kParamIntSeqLen] = 16;
+    v[kParamIntSeqStride] = 1;
+    v[kParamClockDiv] = 3;
+    v[kParamScale] = 4;
+    v[kParamGlideTime] = 100;
+    v[kParamGlideLines] = 63;
+    for (int p = 0; p < kNumParams; ++p)
+        applyParameterChange(state, v, p, kSampleRate);
+}
+
+// Clock and IntSeqTrig gates for sample t, on uneven periods so edges land anywhere in a block
+static float clockAt(int t) { return (t % 37) < 9 ? 5.0f : 0.0f; }
+static float trigAt(int t) { return (t % 53) < 20 ? 5.0f : 0.0f; }
+
+// processBlock() over uneven blocks; every event must match the twin engine run sample by sample
+static void checkEventStream() {
+    static IChingRndState state, twin;
+    NoiseState ns, twinNs;
+    int16_t v[kNumParams];
+    initEngine(&state, v);
+    initEngine(&twin, v);
+
+    EventReader reader;
+    attachReader(&state.events, &reader);
+
+    // Expected events, from the twin one sample at a time
+    std::vector<IChingEvent> expected;
+    const int total = 6000;
+    std::vector<float> quant(total + 1), intseq(total + 1);
+    float lastClock = 0.0f, lastTrig = 0.0f;
+    int divCounter = 0, pendingIntSeq = -1;
+    for (int t = 0; t <= total; ++t) {
+        float clock = clockAt(t), trig = trigAt(t), out[8];
+        IChingRndBuses io = { &clock, &trig, NULL, &out[0], &out[1], &out[2], &out[3], &out[4], &out[5], NULL, NULL };
+        int before = hexagramToIndex(twin.hexagram);
+        processBlock(&twin, &twinNs, v, io, 1, kSampleRate);
+        quant[t] = out[1];
+        intseq[t] = out[2];
+
+        if (pendingIntSeq == t) {
+            expected.push_back({ uint32_t(t), kEventIntSeq, 0, 0, uint8_t(voltsToMidiNote(intseq[t])) });
+            pendingIntSeq = -1;
+        }
+        if (clock > 1.0f && !(lastClock > 1.0f)) {
+            if (++divCounter >= v[kParamClockDiv]) {
+                divCounter = 0;
+                expected.push_back({ uint32_t(t), kEventDivider, 0, 0, 0 });
+            }
+            int after = hexagramToIndex(twin.hexagram);
+            expected.push_back({ uint32_t(t), kEventHexagram, uint8_t(after), uint8_t(after ^ before),
+                                 uint8_t(voltsToMidiNote(quant[t])) });
+        }
+        // The IntSeq output moves on the sample after the edge
+        if (trig > 1.0f && !(lastTrig > 1.0f))
+            pendingIntSeq = t + 1;
+        lastClock = clock;
+        lastTrig = trig;
+    }
+    // Drop what lies past the last block of the run below
+    while (!expected.empty() && expected.back().time >= uint32_t(total))
+        expected.pop_back();
+
+    std::vector<IChingEvent> got;
+    std::vector<float> clock, trig, out[6];
+    for (int t = 0, b = 0; t < total; ++b) {
+        int n = 4 * (1 + (b * 7) % 64);
+        if (n > total - t)
+            n = total - t;
+        clock.resize(n);
+        trig.resize(n);
+        for (auto& o : out)
+            o.resize(n);
+        for (int i = 0; i < n; ++i) {
+            clock[i] = clockAt(t + i);
+            trig[i] = trigAt(t + i);
+        }
+        IChingRndBuses io = { clock.data(), trig.data(), NULL, out[0].data(), out[1].data(), out[2].data(),
+                              out[3].data(), out[4].data(), out[5].data(), NULL, NULL };
+        processBlock(&state, &ns, v, io, n, kSampleRate);
+        IChingEvent e;
+        while (readEvent(&state.events, &reader, &e))
+            got.push_back(e);
+        t += n;
+    }
+    // The last IntSeq step of the run may land on the first sample after it
+    if (!got.empty() && got.back().time == uint32_t(total))
+        got.pop_back();
+
+    check(got.size() == expected.size(), "event count");
+    bool same = got.size() == expected.size();
+    for (size_t k = 0; same && k < got.size(); ++k) {
+        if (!sameEvent(got[k], expected[k])) {
+            printf("  event %d: got type %d at %u (hexagram %d, lines %02x, note %d), expected type %d at %u (hexagram %d, lines %02x, note %d)\n",
+                   int(k), got[k].type, got[k].time, got[k].hexagram, got[k].lines, got[k].note,
+                   expected[k].type, expected[k].time, expected[k].hexagram, expected[k].lines, expected[k].note);
+            same = false;
+        }
+    }
+    check(same, "events match the twin engine");
+    check(reader.dropped == 0, "no events dropped while reading every block");
+    printf("  %d events read back in order\n", int(got.size()));
+}
+
+// In Osc mode nothing is published, IntSeqTrig steps included, whichever table the oscillator plays
+static void checkOscModeSilent() {
+    for (int wave = 0; wave < 2; ++wave) {
+        static IChingRndState state;
+        NoiseState ns;
+        int16_t v[kNumParams];
+        initEngine(&state, v);
+        v[kParamClockSource] = 1;
+        v[kParamOscWave] = int16_t(wave);
+        applyParameterChange(&state, v, kParamClockSource, kSampleRate);
+        applyParameterChange(&state, v, kParamOscWave, kSampleRate);
+
+        EventReader reader;
+        attachReader(&state.events, &reader);
+        const int n = 256;
+        float clock[n], trig[n], out[8][n];
+        for (int t = 0; t < 4000; t += n) {
+            for (int i = 0; i < n; ++i) {
+                clock[i] = clockAt(t + i);
+                trig[i] = trigAt(t + i);
+            }
+            IChingRndBuses io = { clock, trig, NULL, out[0], out[1], out[2], out[3], out[4], out[5], out[6], out[7] };
+            processBlock(&state, &ns, v, io, n, kSampleRate);
+        }
+        IChingEvent e;
+        check(!readEvent(&state.events, &reader, &e) && reader.dropped == 0,
+              wave ? "IntSeq Osc mode publishes no events" : "Hexagram Osc mode publishes no events");
+    }
+}
+
+// A reader left behind resumes from the oldest intact event and counts the ones it lost
+static void checkOverrun(uint32_t startIndex) {
+    static EventQueue q;
+    q.writeIndex = startIndex;
+    EventReader reader;
+    attachReader(&q, &reader);
+
+    // Exactly the capacity: nothing lost
+    for (int k = 0; k < EVENT_QUEUE_LEN - 1; ++k)
+        publishEvent(&q, uint32_t(k), kEventIntSeq, 0, 0, k & 127);
+    IChingEvent e;
+    int count = 0;
+    bool inOrder = true;
+    while (readEvent(&q, &reader, &e))
+        inOrder = inOrder && e.time == uint32_t(count++);
+    check(count == EVENT_QUEUE_LEN - 1 && inOrder && reader.dropped == 0, "a full queue reads back whole");
+
+    // 300 more: the reader gets the last EVENT_QUEUE_LEN - 1 and counts the rest as dropped
+    const int burst = 300;
+    for (int k = 0; k < burst; ++k)
+        publishEvent(&q, uint32_t(1000 + k), kEventIntSeq, 0, 0, k & 127);
+    count = 0;
+    uint32_t first = 1000 + burst - (EVENT_QUEUE_LEN - 1);
+    inOrder = true;
+    while (readEvent(&q, &reader, &e))
+        inOrder = inOrder && e.time == first + uint32_t(count++);
+    check(count == EVENT_QUEUE_LEN - 1 && inOrder, "an overrun reader resumes from the oldest intact event");
+    check(reader.dropped == uint32_t(burst - (EVENT_QUEUE_LEN - 1)), "an overrun reader counts the dropped events");
+}
+
+static bool sameMessage(const MidiMessage& m, uint32_t dest, int status, int data1, int data2) {
+    return m.dest == dest && m.status == status && m.data1 == data1 && m.data2 == data2;
+}
+
+static void checkMidi() {
+    static EventQueue q;
+    MidiOutState midi;
+    attachReader(&q, &midi.reader);
+    MidiMessage m[MIDI_MAX_MESSAGES];
+    const uint32_t destA = 1, destB = 4;
+
+    // Two hexagrams, two IntSeq steps and two divider ticks in one block: only the latest count
+    publishEvent(&q, 10, kEventDivider, 0, 0, 0);
+    publishEvent(&q, 10, kEventHexagram, 5, 5, 60);
+    publishEvent(&q, 20, kEventIntSeq, 0, 0, 50);
+    publishEvent(&q, 30, kEventDivider, 0, 0, 0);
+    publishEvent(&q, 30, kEventHexagram, 9, 12, 64);
+    publishEvent(&q, 40, kEventIntSeq, 0, 0, 52);
+    int n = collectMidi(&q, &midi, destA, 2, m);
+    check(n == 5 && sameMessage(m[0], destA, 0x92, 64, 100) && sameMessage(m[1], destA, 0xB2, 20, 9) &&
+          sameMessage(m[2], destA, 0xB2, 21, 52) && sameMessage(m[3], destA, 0xB2, 22, 127) &&
+          sameMessage(m[4], destA, 0xB2, 22, 0), "a block is coalesced into one note, the latest CCs and one divider pulse");
+
+    // Nothing happened: nothing sent
+    check(collectMidi(&q, &midi, destA, 2, m) == 0, "an idle block sends nothing");
+
+    // The next hexagram releases the held note first
+    publishEvent(&q, 50, kEventHexagram, 1, 8, 62);
+    n = collectMidi(&q, &midi, destA, 2, m);
+    check(n == 3 && sameMessage(m[0], destA, 0x82, 64, 0) && sameMessage(m[1], destA, 0x92, 62, 100),
+          "a new hexagram releases the previous note");
+
+    // Re-routing releases the held note where it was sent
+    n = collectMidi(&q, &midi, destB, 2, m);
+    check(n == 1 && sameMessage(m[0], destA, 0x82, 62, 0), "re-routing releases the held note on the old destination");
+
+    publishEvent(&q, 60, kEventHexagram, 2, 3, 63);
+    collectMidi(&q, &midi, destB, 2, m);
+    n = collectMidi(&q, &midi, destB, 7, m);
+    check(n == 1 && sameMessage(m[0], destB, 0x82, 63, 0), "a channel change releases the held note on the old channel");
+
+    // Switching off releases the held note and sends nothing else
+    publishEvent(&q, 70, kEventHexagram, 3, 1, 65);
+    collectMidi(&q, &midi, destB, 7, m);
+    publishEvent(&q, 80, kEventIntSeq, 0, 0, 40);
+    n = collectMidi(&q, &midi, 0, 7, m);
+    check(n == 1 && sameMessage(m[0], destB, 0x87, 65, 0), "switching off releases the held note only");
+    check(collectMidi(&q, &midi, 0, 7, m) == 0 && midi.note < 0, "MIDI off sends nothing");
+}
+
+int main() {
+    printf("Event stream\n");
+    checkEventStream();
+    checkOscModeSilent();
+    printf("Overrun\n");
+    checkOverrun(0);
+    checkOverrun(0xFFFFFFFFu - 200);
+    printf("MIDI output\n");
+    checkMidi();
+
+    if (failures) {
+        printf("%d check(s) failed\n", failures);
+        return 1;
+    }
+    printf("All event and MIDI checks passed\n");
+    return 0;
+}
@@ -0,0 +1,435 @@
+/*
+
+iching_reference.h keeps the plain scalar block loop of the I_Ching_RND engine as a reference.
+processBlock() in I_Ching_RND_Engine.h is free to be restructured (block fills, SIMD, lookup tables);
+tools/iching_diff.cpp checks it against this loop sample by sample.
+
+Do not optimize this file. From the engine it only takes the types, the state layout, the parameter
+indices and the data tables (scales, integer sequences). Every helper the loop needs is a frozen
+copy below, in the form the original step() computed it: the quantizer resolves the scale on every
+call, the IntSeq output is worked out from the cursor with the original modulo maths instead of
+read from the playback buffer, and the band-limited tables are summed directly in double.
+A change to an engine helper therefore shows up as a divergence instead of being mirrored here.
+
+*/
+
+#ifndef I_CHING_RND_REFERENCE_H
+#define I_CHING_RND_REFERENCE_H
+
+#include <cmath>
+
+#include "I_Ching_RND_Engine.h"
+
+// --- Random hexagrams ---
+inline uint32_t refRandom(IChingRndState* state) {
+    uint32_t x = state->random;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    state->random = x;
+    return x;
+}
+
+inline void refShuffleHexagrams(IChingRndState* state) {
+    for (int i = 0; i < 64; ++i) state->hexagramOrder[i] = i;
+    for (int i = 63; i > 0; --i) {
+        int j = refRandom(state) % (i + 1);
+        int tmp = state->hexagramOrder[i];
+        state->hexagramOrder[i] = state->hexagramOrder[j];
+        state->hexagramOrder[j] = tmp;
+    }
+    state->hexagramStep = 0;
+}
+
+inline void refAdvanceHexagram(IChingRndState* state) {
+    int idx = state->hexagramOrder[state->hexagramStep];
+    for (int b = 0; b < 6; ++b)
+        state->hexagram[b] = (idx >> b) & 1;
+    state->hexagramStep++;
+    if (state->hexagramStep >= 64)
+        refShuffleHexagrams(state);
+}
+
+inline int refHexagramIndex(const int hexagram[6]) {
+    int idx = 0;
+    for (int i = 0; i < 6; ++i)
+        idx |= (hexagram[i] << i);
+    return idx;
+}
+
+inline float refHexagramCV(int idx) {
+    float semitones = (idx < 60) ? float((idx % 12) * 5) : 0.0f;
+    return semitones / 12.0f;
+}
+
+// --- Quantizer ---
+// Intervals of the standard scales, the first entry being the length
+static const int refStandardScales[NUM_STANDARD_SCALES][9] = {
+    { 8, 0, 2, 4, 5, 7, 9, 11, 12 },   // Major
+    { 8, 0, 2, 3, 5, 7, 8, 10, 12 },   // Minor
+    { 8, 0, 2, 3, 5, 7, 8, 11, 12 },   // Harmonic Minor
+    { 8, 0, 2, 3, 5, 7, 9, 11, 12 },   // Melodic Minor
+    { 8, 0, 2, 4, 5, 7, 9, 10, 12 },   // Mixolydian
+    { 8, 0, 2, 3, 5, 7, 9, 10, 12 },   // Dorian
+    { 8, 0, 2, 4, 6, 7, 9, 11, 12 },   // Lydian
+    { 8, 0, 1, 3, 5, 7, 8, 10, 12 },   // Phrygian
+    { 8, 0, 2, 3, 5, 7, 8, 10, 12 },   // Aeolian
+    { 8, 0, 1, 3, 5, 6, 8, 10, 12 },   // Locrian
+    { 5, 0, 2, 4, 7, 9, 12 },          // Maj Pent
+    { 5, 0, 3, 5, 7, 10, 12 },         // Min Pent
+    { 7, 0, 2, 4, 6, 8, 10, 12 },      // Whole Tone
+    { 8, 0, 1, 3, 4, 6, 7, 9, 10 },    // Octatonic HW
+    { 8, 0, 2, 3, 5, 6, 8, 9, 11 },    // Octatonic WH
+    { 8, 0, 2, 4, 5, 7, 9, 11, 12 },   // Ionian
+};
+
+inline float refQuantize(float v, int scaleIdx, int root, int transpose, int maskRotate) {
+    int scale[SCALE_MAX_LEN] = {};
+    int scaleLen = 0;
+    if (scaleIdx < NUM_STANDARD_SCALES) {
+        scaleLen = refStandardScales[scaleIdx][0];
+        for (int i = 0; i < scaleLen; ++i)
+            scale[i] = refStandardScales[scaleIdx][1 + i];
+    } else if (scaleIdx < NUM_SCALES) {
+        for (int i = 0; i < SCALE_MAX_LEN; ++i)
+            scale[i] = (int)exotic_scales[scaleIdx - NUM_STANDARD_SCALES][i];
+        scaleLen = SCALE_MAX_LEN;
+    }
+
+    float note = v * 12.0f;
+    int n = static_cast<int>(roundf(note));
+    n += root + transpose;
+    int scaleDegree = 0;
+    int minDist = 128;
+    for (int i = 0; i < scaleLen; ++i) {
+        int deg = (scale[i] + maskRotate) % 12;
+        int dist = abs((n % 12) - deg);
+        if (dist < minDist) {
+            minDist = dist;
+            scaleDegree = i;
+        }
+    }
+    int quantized = (n / 12) * 12 + scale[scaleDegree];
+    return quantized / 12.0f;
+}
+
+// --- Integer sequence ---
+// Cursor positions in one pass of the window: Len for a loop, forward then back without
+// repeating the ends for a pendulum
+inline int refIntSeqCycle(const int16_t* v) {
+    int len = v[kParamIntSeqLen];
+    return (v[kParamIntSeqDir] == 1 && len > 1) ? len * 2 - 2 : len;
+}
+
+// IntSeq Out (volts) at cursor `pos`
+inline float refIntSeqVolts(const int16_t* v, int pos) {
+    int intseqStart = v[kParamIntSeqStart];
+    int intseqLen = v[kParamIntSeqLen];
+    int intseqStride = v[kParamIntSeqStride];
+    int intseqMod = v[kParamIntSeqMod];
+
+    int offset;
+    if (v[kParamIntSeqDir] == 1) {
+        int cycle = refIntSeqCycle(v);
+        int posInCycle = pos % cycle;
+        if (posInCycle >= intseqLen)
+            offset = intseqStart + ((cycle - posInCycle) * intseqStride);
+        else
+            offset = intseqStart + (posInCycle * intseqStride);
+    } else {
+        offset = intseqStart + ((pos * intseqStride) % intseqLen);
+    }
+
+    int value = intseq_tables[v[kParamIntSeqSelect]][offset % INTSEQ_MAX_LEN];
+    if (intseqMod > 1) value %= intseqMod;
+    int degree = value % 12;
+    if (degree < 0) degree += 12;
+    return refQuantize(degree / 12.0f, v[kParamScale], v[kParamRoot], v[kParamTranspose], v[kParamMaskRotate]);
+}
+
+inline void refAdvanceIntSeq(IChingRndState* state, const int16_t* v) {
+    state->intseq_pos = (state->intseq_pos + 1) % refIntSeqCycle(v);
+}
+
+// --- Noise ---
+inline float refWhiteNoise(IChingRndState* state) {
+    return ((refRandom(state) >> 8) & 0xFFFF) / 32768.0f - 1.0f;
+}
+
+inline float refPinkNoise(float in, float* state) {
+    state[0] = 0.99886f * state[0] + 0.0555179f * in;
+    state[1] = 0.99332f * state[1] + 0.0750759f * in;
+    state[2] = 0.96900f * state[2] + 0.1538520f * in;
+    return 0.5362f * (state[0] + state[1] + state[2]) + 0.1f * in;
+}
+
+inline float refBrownNoise(float in, float* state) {
+    state[0] += 0.05f * in;
+    state[0] -= 0.0005f * state[0];
+    return state[0];
+}
+
+inline float refBlueNoise(float in, float* state, float sampleRate) {
+    float alpha = sampleRate / (sampleRate + 2.0f * M_PI * 100.0f);
+    float out = alpha * (*state + in - *state);
+    *state = in;
+    return out;
+}
+
+inline float refNoise(IChingRndState* state, NoiseState* ns, int noiseType, float sampleRate) {
+    float wn = refWhiteNoise(state);
+    float n = 0.0f;
+    switch (noiseType) {
+        case 0: n = wn; break;
+        case 1: n = refPinkNoise(wn, ns->pink); break;
+        case 2: n = refBrownNoise(wn, &ns->brown); break;
+        case 3: n = refBlueNoise(wn, &ns->blueLast, sampleRate); break;
+        default: n = wn; break;
+    }
+    return n * 5.0f;
+}
+
+// --- Oscillator ---
+// Only the steps, the phase and the band-limited tables of OscState are used; the tables are
+// filled when first read, like the engine's, since filling all six every cycle is too slow here
+inline void refSetOscSteps(OscState* osc, const float* values, int steps) {
+    for (int k = 0; k < steps; ++k)
+        osc->stepped[k] = values[k];
+    osc->steps = steps;
+    osc->levelsBuilt = 0;
+}
+
+inline void refHexagramOscTable(IChingRndState* state) {
+    float values[64];
+    for (int k = 0; k < 64; ++k) {
+        state->oscOrder[k] = uint8_t(state->hexagramOrder[k]);
+        values[k] = (state->oscOrder[k] - 31.5f) * (5.0f / 31.5f);
+    }
+    refSetOscSteps(&state->osc, values, 64);
+}
+
+// One pass of the IntSeq window, scaled to +-5V
+inline void refIntSeqOscTable(IChingRndState* state, const int16_t* v) {
+    int n = refIntSeqCycle(v);
+    float volts[INTSEQ_PLAY_MAX_LEN];
+    for (int k = 0; k < n; ++k)
+        volts[k] = refIntSeqVolts(v, k);
+    float lo = volts[0], hi = volts[0];
+    for (int k = 1; k < n; ++k) {
+        if (volts[k] < lo) lo = volts[k];
+        if (volts[k] > hi) hi = volts[k];
+    }
+    float values[INTSEQ_PLAY_MAX_LEN];
+    float gain = (hi > lo) ? 10.0f / (hi - lo) : 0.0f;
+    for (int k = 0; k < n; ++k)
+        values[k] = (volts[k] - lo) * gain - ((hi > lo) ? 5.0f : 0.0f);
+    refSetOscSteps(&state->osc, values, n);
+}
+
+inline void refResetOscillator(IChingRndState* state, const int16_t* v) {
+    state->osc.phase = 0.0f;
+    if (v[kParamOscWave] == 1) {
+        state->intseq_pos = 0;
+        refIntSeqOscTable(state, v);
+    } else {
+        refShuffleHexagrams(state);
+        refHexagramOscTable(state);
+        refAdvanceHexagram(state);
+    }
+}
+
+// Band-limited table `level`: the Fourier series of the steps up to the level's top harmonic,
+// each coefficient and table point summed directly in double
+inline void refOscLevel(OscState* osc, int level) {
+    int steps = osc->steps;
+    int top = OSC_MAX_HARMONIC >> level;
+    if (2 * top > steps)
+        top = steps / 2;
+    const double twoPi = 2.0 * 3.14159265358979323846;
+
+    double dc = 0.0;
+    for (int k = 0; k < steps; ++k)
+        dc += osc->stepped[k];
+    dc /= steps;
+
+    double re[OSC_MAX_HARMONIC + 1], im[OSC_MAX_HARMONIC + 1];
+    for (int harmonic = 1; harmonic <= top; ++harmonic) {
+        re[harmonic] = im[harmonic] = 0.0;
+        for (int k = 0; k < steps; ++k) {
+            double w = twoPi * ((harmonic * k) % steps) / steps;
+            re[harmonic] += osc->stepped[k] * cos(w);
+            im[harmonic] += osc->stepped[k] * sin(w);
+        }
+        double gain = (2 * harmonic == steps) ? 1.0 / steps : 2.0 / steps;
+        re[harmonic] *= gain;
+        im[harmonic] *= gain;
+    }
+
+    float* table = osc->bandLimited[level];
+    for (int m = 0; m < OSC_TABLE_LEN; ++m) {
+        double x = dc;
+        for (int harmonic = 1; harmonic <= top; ++harmonic) {
+            double w = twoPi * ((harmonic * m) % OSC_TABLE_LEN) / OSC_TABLE_LEN;
+            x += re[harmonic] * cos(w) + im[harmonic] * sin(w);
+        }
+        table[m] = float(x);
+    }
+    table[OSC_TABLE_LEN] = table[0];
+    osc->levelsBuilt |= 1 << level;
+}
+
+inline int refOscAdvance(OscState* osc, float inc, bool* wrapped) {
+    int before = int(osc->phase * osc->steps);
+    osc->phase += inc;
+    *wrapped = osc->phase >= 1.0f;
+    if (*wrapped) {
+        osc->phase -= 1.0f;
+        return int(osc->phase * osc->steps) + osc->steps - before;
+    }
+    return int(osc->phase * osc->steps) - before;
+}
+
+inline int refOscStep(const OscState* osc) {
+    int k = int(osc->phase * osc->steps);
+    return k < osc->steps ? k : osc->steps - 1;
+}
+
+inline float refOscBandLimited(OscState* osc, float inc) {
+    int level = 0;
+    while (level < OSC_NUM_LEVELS - 1 && (OSC_MAX_HARMONIC >> level) * inc > 0.5f)
+        ++level;
+    if (!(osc->levelsBuilt & (1 << level)))
+        refOscLevel(osc, level);
+    float pos = osc->phase * OSC_TABLE_LEN;
+    int i = int(pos);
+    if (i >= OSC_TABLE_LEN) i = OSC_TABLE_LEN - 1;
+    float frac = pos - i;
+    const float* table = osc->bandLimited[level];
+    return table[i] + (table[i + 1] - table[i]) * frac;
+}
+
+inline float refOscIncrement(float pitchVolts, float sampleRate) {
+    float inc = 130.8128f * exp2f(pitchVolts) / sampleRate;
+    return inc < 0.5f ? inc : 0.5f;
+}
+
+// --- Reference entry points ---
+// A freshly constructed state, seeded with `seed`
+inline void initReference(IChingRndState* state, NoiseState* ns, uint32_t seed) {
+    *state = IChingRndState();
+    *ns = NoiseState();
+    state->random = seed ? seed : 1;
+    refShuffleHexagrams(state);
+}
+
+// Reference for applyParameterChange(): what the loop below depends on
+inline void applyParameterChangeReference(IChingRndState* state, const int16_t* v, int p) {
+    switch (p) {
+        case kParamScale:
+        case kParamRoot:
+        case kParamTranspose:
+        case kParamMaskRotate:
+        case kParamIntSeqSelect:
+        case kParamIntSeqMod:
+        case kParamIntSeqStart:
+        case kParamIntSeqLen:
+        case kParamIntSeqDir:
+        case kParamIntSeqStride:
+            state->intseq_pos %= refIntSeqCycle(v);
+            if (v[kParamClockSource] == 1 && v[kParamOscWave] == 1) {
+                refIntSeqOscTable(state, v);
+                state->osc.phase = (state->intseq_pos + 0.5f) / state->osc.steps;
+            }
+            break;
+        case kParamClockSource:
+        case kParamOscWave:
+            if (v[kParamClockSource] == 1)
+                refResetOscillator(state, v);
+            break;
+    }
+}
+
+// Reference for processBlock(): one sample at a time, in the order of the original step()
+inline void processBlockReference(IChingRndState* state, NoiseState* ns, const int16_t* v, const IChingRndBuses& io, int numFrames, float sampleRate)
+{
+    int clockDiv  = v[kParamClockDiv];
+    int noiseType = v[kParamNoiseType];
+    int scale = v[kParamScale];
+    int root = v[kParamRoot];
+    int transpose = v[kParamTranspose];
+    int maskRotate = v[kParamMaskRotate];
+    bool oscMode = v[kParamClockSource] == 1;
+    bool oscIntSeq = v[kParamOscWave] == 1;
+    float oscPitch = v[kParamOscPitch] / 12.0f;
+
+    if (oscMode && state->osc.steps == 0)
+        refResetOscillator(state, v);
+    float oscInc = refOscIncrement(oscPitch, sampleRate);
+
+    for (int i = 0; i < numFrames; ++i) {
+        // Oscillator: the phase accumulator replaces the Clock (or IntSeqTrig) input
+        int oscSteps = 0;
+        bool oscWrapped = false;
+        if (oscMode) {
+            if (io.pitchIn)
+                oscInc = refOscIncrement(oscPitch + io.pitchIn[i], sampleRate);
+            oscSteps = refOscAdvance(&state->osc, oscInc, &oscWrapped);
+        }
+
+        int clock = io.clockIn[i] > 1.0f ? 1 : 0;
+        int clockEdges = (clock && !state->lastClock) ? 1 : 0;
+        if (oscMode && !oscIntSeq) {
+            // Internal clock: high for the first half of each step
+            clock = (state->osc.phase * state->osc.steps - refOscStep(&state->osc)) < 0.5f ? 1 : 0;
+            clockEdges = oscSteps;
+        }
+        io.clockThruOut[i] = clock ? 5.0f : 0.0f;
+
+        // Clock Divider
+        for (int e = 0; e < clockEdges; ++e) {
+            state->div_counter++;
+            if (state->div_counter >= clockDiv) {
+                state->div_state = 1;
+                state->div_counter = 0;
+            } else {
+                state->div_state = 0;
+            }
+        }
+        io.clockDivOut[i] = state->div_state ? 5.0f : 0.0f;
+
+        // Rising Edge: Hexagram Update
+        for (int e = 0; e < clockEdges; ++e)
+            refAdvanceHexagram(state);
+        state->lastClock = clock;
+
+        // A new cycle plays the order shuffled at the end of the previous one
+        if (oscMode && !oscIntSeq && oscWrapped)
+            refHexagramOscTable(state);
+
+        int idx = refHexagramIndex(state->hexagram);
+        io.cvOut[i] = refHexagramCV(idx);
+        io.quantOut[i] = refQuantize(idx / 12.0f, scale, root, transpose, maskRotate);
+
+        // Integer Sequence
+        if (oscMode && oscIntSeq) {
+            for (int e = 0; e < oscSteps; ++e)
+                refAdvanceIntSeq(state, v);
+        }
+        io.intseqOut[i] = refIntSeqVolts(v, state->intseq_pos);
+
+        int intseqTrig = io.intseqTrigIn[i] > 1.0f ? 1 : 0;
+        if (intseqTrig && !state->lastIntSeqTrig && !(oscMode && oscIntSeq))
+            refAdvanceIntSeq(state, v);
+        state->lastIntSeqTrig = intseqTrig;
+
+        if (io.oscOut)
+            io.oscOut[i] = oscMode ? state->osc.stepped[refOscStep(&state->osc)] : 0.0f;
+        if (io.oscBLOut)
+            io.oscBLOut[i] = oscMode ? refOscBandLimited(&state->osc, oscInc) : 0.0f;
+
+        // Noise Generation
+        io.noiseOut[i] = refNoise(state, ns, noiseType, sampleRate);
+    }
+}
+
+#endif // I_CHING_RND_REFERENCE_H